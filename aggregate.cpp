@@ -0,0 +1,243 @@
+#include "aggregate.h"
+#include "record_sort.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const std::size_t MIN_BUCKETS = 64;
+
+    // splitmix64 finalizer: small keys such as ages spread over every bucket
+    std::uint64_t mix(std::uint64_t key) {
+        key += 0x9E3779B97F4A7C15ull;
+        key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+        key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+        return key ^ (key >> 31);
+    }
+
+    bool isText(Field field) {
+        return field == Field::FirstName || field == Field::LastName || field == Field::SSN;
+    }
+
+    const char* textOf(const Employee& emp, Field field) {
+        switch (field) {
+        case Field::FirstName: return emp.firstName;
+        case Field::LastName: return emp.lastName;
+        default: return emp.ssn;
+        }
+    }
+
+    // Three-way compare of one field of two records
+    int compareField(Field field, const Employee& a, const Employee& b) {
+        if (isText(field)) {
+            return std::strcmp(textOf(a, field), textOf(b, field));
+        }
+        std::uint64_t x = sortKeyOf(field, a);
+        std::uint64_t y = sortKeyOf(field, b);
+        return (x < y) ? -1 : (y < x) ? 1 : 0;
+    }
+
+    // The field's value as an output cell
+    AggregateValue fieldValue(Field field, const Employee& emp) {
+        AggregateValue value;
+        switch (field) {
+        case Field::Id: value.type = AggregateValue::Type::Int; value.intValue = emp.id; break;
+        case Field::Age: value.type = AggregateValue::Type::Int; value.intValue = emp.age; break;
+        case Field::Salary: value.type = AggregateValue::Type::Float; value.floatValue = emp.salary; break;
+        default: value.type = AggregateValue::Type::Text; value.text = textOf(emp, field); break;
+        }
+        return value;
+    }
+}
+
+HashAggregator::HashAggregator(const QueryPlan& plan, const Employee* records, std::pmr::memory_resource* memory)
+    : plan(&plan), records(records), groupSlots(memory), groupHashes(memory), accumulators(memory), buckets(memory) {
+    if (!plan.grouped) {
+        // Everything falls into one group, which exists even with no rows
+        groupSlots.push_back(0);
+        groupHashes.push_back(0);
+        accumulators.resize(plan.aggregates.size());
+    }
+}
+
+// Hash of the GROUP BY value: the exact sort key for numbers, FNV-1a over
+// the whole string for text
+std::uint64_t HashAggregator::hashKey(const Employee& emp) const {
+    if (!isText(plan->groupBy)) {
+        return mix(sortKeyOf(plan->groupBy, emp));
+    }
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const char* c = textOf(emp, plan->groupBy); *c != '\0'; c++) {
+        hash = (hash ^ static_cast<unsigned char>(*c)) * 1099511628211ull;
+    }
+    return mix(hash);
+}
+
+// Returns the group of the row at slot, creating it if the key is new
+std::size_t HashAggregator::findGroup(std::size_t slot, std::uint64_t hash) {
+    if ((groupSlots.size() + 1) * 2 > buckets.size()) {
+        grow();                     // Keep the table at most half full
+    }
+    std::size_t mask = buckets.size() - 1;
+    std::size_t i = static_cast<std::size_t>(hash) & mask;
+    while (buckets[i] != 0) {
+        std::size_t group = buckets[i] - 1;
+        if (groupHashes[group] == hash && compareField(plan->groupBy, records[groupSlots[group]], records[slot]) == 0) {
+            return group;
+        }
+        i = (i + 1) & mask;
+    }
+
+    std::size_t group = groupSlots.size();
+    buckets[i] = static_cast<std::uint32_t>(group + 1);
+    groupSlots.push_back(slot);
+    groupHashes.push_back(hash);
+    accumulators.resize(accumulators.size() + plan->aggregates.size());
+    return group;
+}
+
+// Doubles the bucket array and reinserts every group
+void HashAggregator::grow() {
+    std::size_t size = std::max(MIN_BUCKETS, buckets.size() * 2);
+    buckets.assign(size, 0);
+    for (std::size_t group = 0; group < groupHashes.size(); group++) {
+        std::size_t i = static_cast<std::size_t>(groupHashes[group]) & (size - 1);
+        while (buckets[i] != 0) {
+            i = (i + 1) & (size - 1);
+        }
+        buckets[i] = static_cast<std::uint32_t>(group + 1);
+    }
+}
+
+void HashAggregator::add(std::size_t slot) {
+    std::size_t group = plan->grouped ? findGroup(slot, hashKey(records[slot])) : 0;
+    accumulate(&accumulators[group * plan->aggregates.size()], slot);
+}
+
+// Updates one group's accumulators with a row
+void HashAggregator::accumulate(Accumulator* row, std::size_t slot) {
+    const Employee& emp = records[slot];
+    for (std::size_t c = 0; c < plan->aggregates.size(); c++) {
+        const AggregateColumn& column = plan->aggregates[c];
+        Accumulator& acc = row[c];
+        switch (column.op) {
+        case AggregateOp::Sum:
+        case AggregateOp::Avg:
+            if (column.field == Field::Salary) {
+                acc.floatSum += emp.salary;
+            }
+            else {
+                acc.intSum += column.field == Field::Age ? emp.age : emp.id;
+            }
+            break;
+        case AggregateOp::Min:
+            if (acc.count == 0 || compareField(column.field, emp, records[acc.minSlot]) < 0) {
+                acc.minSlot = slot;
+            }
+            break;
+        case AggregateOp::Max:
+            if (acc.count == 0 || compareField(column.field, emp, records[acc.maxSlot]) > 0) {
+                acc.maxSlot = slot;
+            }
+            break;
+        default:
+            break;
+        }
+        acc.count++;
+    }
+}
+
+// Adds another group's accumulators (same key) into this one
+void HashAggregator::combine(Accumulator* row, const Accumulator* other) {
+    for (std::size_t c = 0; c < plan->aggregates.size(); c++) {
+        const AggregateColumn& column = plan->aggregates[c];
+        Accumulator& acc = row[c];
+        const Accumulator& from = other[c];
+        if (from.count == 0) {
+            continue;
+        }
+        if (acc.count == 0 ||
+            compareField(column.field, records[from.minSlot], records[acc.minSlot]) < 0) {
+            acc.minSlot = from.minSlot;
+        }
+        if (acc.count == 0 ||
+            compareField(column.field, records[from.maxSlot], records[acc.maxSlot]) > 0) {
+            acc.maxSlot = from.maxSlot;
+        }
+        acc.count += from.count;
+        acc.intSum += from.intSum;
+        acc.floatSum += from.floatSum;
+    }
+}
+
+void HashAggregator::merge(const HashAggregator& other) {
+    std::size_t width = plan->aggregates.size();
+    for (std::size_t group = 0; group < other.groupSlots.size(); group++) {
+        std::size_t into = plan->grouped ? findGroup(other.groupSlots[group], other.groupHashes[group]) : 0;
+        combine(&accumulators[into * width], &other.accumulators[group * width]);
+    }
+}
+
+AggregateValue HashAggregator::valueOf(const AggregateColumn& column, const Accumulator& acc, std::size_t keySlot) const {
+    AggregateValue value;
+    if (column.op == AggregateOp::Key) {
+        return fieldValue(column.field, records[keySlot]);
+    }
+    if (column.op == AggregateOp::Count) {
+        value.type = AggregateValue::Type::Int;
+        value.intValue = static_cast<long long>(acc.count);
+        return value;
+    }
+    if (acc.count == 0) {
+        return value;               // Null, as in SQL
+    }
+    bool isFloat = column.field == Field::Salary;
+    switch (column.op) {
+    case AggregateOp::Sum:
+        value.type = isFloat ? AggregateValue::Type::Float : AggregateValue::Type::Int;
+        value.intValue = acc.intSum;
+        value.floatValue = acc.floatSum;
+        break;
+    case AggregateOp::Avg:
+        value.type = AggregateValue::Type::Float;
+        value.floatValue = (isFloat ? acc.floatSum : static_cast<double>(acc.intSum)) / static_cast<double>(acc.count);
+        break;
+    case AggregateOp::Min: return fieldValue(column.field, records[acc.minSlot]);
+    case AggregateOp::Max: return fieldValue(column.field, records[acc.maxSlot]);
+    default: break;
+    }
+    return value;
+}
+
+AggregateTable HashAggregator::finish() const {
+    AggregateTable table;
+    for (const AggregateColumn& column : plan->aggregates) {
+        table.columns.push_back(aggregateName(column));
+    }
+
+    std::vector<std::size_t> order(groupSlots.size());
+    for (std::size_t group = 0; group < order.size(); group++) {
+        order[group] = group;
+    }
+    if (plan->grouped) {
+        bool ascending = plan->orderBy.empty() || plan->orderBy[0].ascending;
+        std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            int cmp = compareField(plan->groupBy, records[groupSlots[a]], records[groupSlots[b]]);
+            return ascending ? cmp < 0 : cmp > 0;
+        });
+    }
+    if (plan->limit >= 0 && static_cast<std::size_t>(plan->limit) < order.size()) {
+        order.resize(static_cast<std::size_t>(plan->limit));
+    }
+
+    std::size_t width = plan->aggregates.size();
+    table.rows.reserve(order.size());
+    for (std::size_t group : order) {
+        std::vector<AggregateValue> row;
+        row.reserve(width);
+        for (std::size_t c = 0; c < width; c++) {
+            row.push_back(valueOf(plan->aggregates[c], accumulators[group * width + c], groupSlots[group]));
+        }
+        table.rows.push_back(std::move(row));
+    }
+    return table;
+}
@@ -0,0 +1,71 @@
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+#include "query.h"
+#include "record.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+// One cell of an aggregate query's output
+struct AggregateValue {
+    enum class Type { Null, Int, Float, Text };
+    Type type = Type::Null;        // Null: SUM/AVG/MIN/MAX over no rows
+    long long intValue = 0;        // COUNT, and SUM/MIN/MAX of id and age
+    double floatValue = 0.0;       // AVG, and SUM/MIN/MAX of salary
+    std::string text;              // MIN/MAX and GROUP BY values of text fields
+};
+
+// Output of an aggregate query: one row per group, or a single row when
+// there is no GROUP BY
+struct AggregateTable {
+    std::vector<std::string> columns;                  // Headers, e.g. "COUNT(*)"
+    std::vector<std::vector<AggregateValue>> rows;
+};
+
+// Hash aggregation over record slots in one pass. Each group keeps one of
+// its rows as the key, so keys (text included) are compared in place in the
+// records rather than copied, plus one accumulator per aggregate column.
+// Large scans build one aggregator per chunk and merge() them afterwards;
+// the records must stay mapped until finish(). The group table is allocated
+// from memory (a query's arena, see query_arena.h).
+class HashAggregator {
+public:
+    HashAggregator(const QueryPlan& plan, const Employee* records,
+        std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+    void add(std::size_t slot);                        // Folds one matching row in
+    void merge(const HashAggregator& other);           // Folds in a partial result over the same records
+    std::size_t groupCount() const { return groupSlots.size(); }
+
+    // Groups in GROUP BY field order (descending with ORDER BY ... DESC),
+    // cut to the plan's LIMIT
+    AggregateTable finish() const;
+
+private:
+    struct Accumulator {
+        std::uint64_t count = 0;
+        long long intSum = 0;              // Id, Age
+        double floatSum = 0.0;             // Salary
+        std::size_t minSlot = 0;           // Row holding the smallest value so far
+        std::size_t maxSlot = 0;
+    };
+
+    const QueryPlan* plan;
+    const Employee* records;
+    std::pmr::vector<std::size_t> groupSlots;      // First row seen of each group
+    std::pmr::vector<std::uint64_t> groupHashes;
+    std::pmr::vector<Accumulator> accumulators;    // groups x aggregate columns, row-major
+    std::pmr::vector<std::uint32_t> buckets;       // Open addressing: group + 1, 0 = empty
+
+    std::uint64_t hashKey(const Employee& emp) const;
+    std::size_t findGroup(std::size_t slot, std::uint64_t hash);
+    void grow();
+    void accumulate(Accumulator* row, std::size_t slot);
+    void combine(Accumulator* row, const Accumulator* other);
+    AggregateValue valueOf(const AggregateColumn& column, const Accumulator& acc, std::size_t keySlot) const;
+};
+
+#endif
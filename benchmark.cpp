@@ -0,0 +1,405 @@
+#include "employee.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+// Benchmarks and load generator for the EmployeeDB engine.
+// Usage: benchmark [records] [maxThreads]
+//        benchmark stress [records] [readers] [seconds]
+//        benchmark suite [maxRecords] [minRecords]
+//        benchmark generate records path
+// Runs in a fresh temp directory (the database files have fixed names) and
+// prints one CSV line per measurement.
+// The default mode times the parallel scan and sort paths per thread count.
+// Stress mode runs reader threads (lookups, queries, sorts) against one
+// thread inserting and deleting, checks every row the readers see, and
+// exits with status 1 if any row was wrong.
+// Suite mode times every engine operation the console uses (opening the
+// database, inserts, deletes, SSN lookups, sorts per field and queries) at
+// 10^3, 10^4, ... records up to maxRecords (default 10^6).
+// Generate mode writes records synthetic employees with unique, valid SSNs
+// to path in the binary record format (a ready-made employees.dat).
+
+namespace {
+    const char* FIRST_NAMES[] = { "James", "Mary", "John", "Linda", "Robert", "Susan", "Michael", "Karen" };
+    const char* LAST_NAMES[] = { "Smith", "Johnson", "Williams", "Brown", "Jones", "Garcia", "Miller", "Davis",
+        "Rodriguez", "Martinez", "Hernandez", "Lopez", "Wilson", "Anderson", "Thomas", "Taylor" };
+
+    // Employee number i of the generated data set; SSNs are unique per i
+    Employee makeEmployee(std::size_t i, std::uint64_t random) {
+        Employee emp;
+        std::memset(&emp, 0, sizeof(Employee));
+        emp.id = static_cast<int>(i + 1);
+        std::strcpy(emp.firstName, FIRST_NAMES[random % 8]);
+        std::strcpy(emp.lastName, LAST_NAMES[(random >> 3) % 16]);
+        // Spread i over the SSN space with an odd multiplier (a bijection mod 10^9)
+        std::uint64_t digits = (i * 387420489ull) % 1000000000ull;
+        std::snprintf(emp.ssn, sizeof(emp.ssn), "%03u-%02u-%04u", static_cast<unsigned>(digits / 1000000),
+            static_cast<unsigned>(digits / 10000 % 100), static_cast<unsigned>(digits % 10000));
+        emp.salary = static_cast<float>(20000 + (random >> 7) % 180000);
+        emp.age = static_cast<int>(18 + (random >> 25) % 50);
+        emp.isDeleted = false;
+        return emp;
+    }
+
+    // True if a row could have come from makeEmployee (no torn or mixed fields)
+    bool isGenerated(const Employee& emp) {
+        bool first = false, last = false;
+        for (const char* name : FIRST_NAMES) first = first || std::strcmp(emp.firstName, name) == 0;
+        for (const char* name : LAST_NAMES) last = last || std::strcmp(emp.lastName, name) == 0;
+        return first && last && isValidSSN(emp.ssn) && emp.age >= 18 && emp.age < 68 &&
+            emp.salary >= 20000 && emp.salary < 200000;
+    }
+
+    // Writes n records with unique, valid SSNs straight into the data file
+    void generate(const std::string& path, std::size_t n) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot create " + path);
+        }
+        std::vector<Employee> batch;
+        batch.reserve(8192);
+        std::uint64_t state = 88172645463325252ull;
+        auto next = [&]() {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        };
+        for (std::size_t i = 0; i < n; i++) {
+            batch.push_back(makeEmployee(i, next()));
+            if (batch.size() == 8192 || i + 1 == n) {
+                out.write(reinterpret_cast<const char*>(batch.data()), static_cast<std::streamsize>(batch.size() * sizeof(Employee)));
+                batch.clear();
+            }
+        }
+        if (!out.flush()) {
+            throw std::runtime_error("Error writing " + path);
+        }
+    }
+
+    // Removes every file the database creates in the working directory
+    void removeDatabase() {
+        std::remove("employees.dat");
+        std::remove("employees.meta");
+        std::remove("employees.ssn.idx");
+        std::remove("employees.salary.idx");
+        std::remove("employees.age.idx");
+        std::remove("employees.lastname.idx");
+        std::remove("employees.wal");
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Best of three runs, in seconds
+    double timeBest(const std::function<void()>& run) {
+        double best = 1e30;
+        for (int i = 0; i < 3; i++) {
+            auto start = std::chrono::steady_clock::now();
+            run();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    // Times each scan and sort at 1, 2, 4, ... maxThreads threads
+    void scaling(EmployeeDB& db, std::size_t records, std::size_t maxThreads) {
+        std::cout << "operation,threads,records,seconds\n";
+        std::size_t sink = 0;           // Keeps results observable
+        for (std::size_t threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+            db.setThreadCount(threads);
+            auto report = [&](const char* name, const std::function<void()>& run) {
+                std::printf("%s,%zu,%zu,%.6f\n", name, threads, records, timeBest(run));
+            };
+
+            // Cold sorts: a kept order would turn runs 2 and 3 into a copy
+            db.setSortOrderReuse(false);
+            report("sort_salary", [&]() { sink += db.sortedBy(1, true).size(); });
+            report("sort_age", [&]() { sink += db.sortedBy(2, false).size(); });
+            report("sort_lastname", [&]() { sink += db.sortedBy(3, true).size(); });
+            report("sort_ssn", [&]() { sink += db.sortedBy(4, true).size(); });
+            db.setSortOrderReuse(true);
+
+            db.setColumnarScans(true);
+            report("scan_columnar", [&]() {
+                sink += db.query("SELECT id FROM employees WHERE salary > 150000 AND age < 30").size();
+            });
+            db.setColumnarScans(false);
+            report("scan_rows", [&]() {
+                sink += db.query("SELECT id FROM employees WHERE lastName = 'Smith' OR age = 40").size();
+            });
+
+            if (threads == maxThreads) {
+                break;
+            }
+        }
+        std::cerr << "checksum " << sink << "\n";
+    }
+
+    // One line per measurement: total seconds for ops operations
+    void reportSuite(const char* operation, std::size_t records, std::size_t ops, double seconds) {
+        std::printf("%s,%zu,%zu,%.6f,%.0f\n", operation, records, ops, seconds,
+            seconds > 0 ? static_cast<double>(ops) / seconds : 0.0);
+        std::fflush(stdout);
+    }
+
+    // Times the engine operations behind each console command on a freshly
+    // generated database of `records` employees
+    void suite(std::size_t records) {
+        removeDatabase();
+        generate("employees.dat", records);
+        std::size_t sink = 0;
+
+        // Startup: the first open builds the directory and every index from the
+        // data file; later opens load them
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<EmployeeDB> db(new EmployeeDB());
+        reportSuite("open_cold", records, 1, secondsSince(start));
+        db.reset();
+        start = std::chrono::steady_clock::now();
+        db.reset(new EmployeeDB());
+        reportSuite("open_warm", records, 1, secondsSince(start));
+
+        std::mt19937_64 rng(42);
+        std::size_t ops = std::min<std::size_t>(records, 1000);
+
+        // addEmployee: one durable insert at a time, SSNs continuing the sequence
+        start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < ops; i++) {
+            db->insert(makeEmployee(records + i, rng()));
+        }
+        reportSuite("insert", records, ops, secondsSince(start));
+
+        // deleteEmployee on random generated IDs (repeats just miss)
+        start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < ops; i++) {
+            sink += db->erase(static_cast<int>(1 + rng() % records));
+        }
+        reportSuite("erase", records, ops, secondsSince(start));
+
+        // searchBySSN: half hits on generated SSNs, half misses
+        std::size_t lookups = std::min<std::size_t>(records, 100000);
+        std::vector<Employee> probes;
+        probes.reserve(lookups);
+        for (std::size_t i = 0; i < lookups; i++) {
+            std::size_t n = rng() % records;
+            probes.push_back(makeEmployee(i % 2 == 0 ? n : records + ops + n, 0));
+        }
+        start = std::chrono::steady_clock::now();
+        for (const Employee& probe : probes) {
+            sink += db->findBySSN(probe.ssn).has_value();
+        }
+        reportSuite("find_ssn", records, lookups, secondsSince(start));
+
+        start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < lookups; i++) {
+            sink += db->findById(static_cast<int>(1 + rng() % records)).has_value();
+        }
+        reportSuite("find_id", records, lookups, secondsSince(start));
+
+        // indexByField for each field
+        // Cold sorts, then repeat sorts served from the kept order
+        static const char* sortNames[] = { "sort_salary", "sort_age", "sort_lastname", "sort_ssn" };
+        static const char* reusedNames[] = { "sort_salary_reused", "sort_age_reused", "sort_lastname_reused", "sort_ssn_reused" };
+        db->setSortOrderReuse(false);
+        for (int field = 1; field <= 4; field++) {
+            reportSuite(sortNames[field - 1], records, 1, timeBest([&]() { sink += db->sortedBy(field, true).size(); }));
+        }
+        db->setSortOrderReuse(true);
+        for (int field = 1; field <= 4; field++) {
+            sink += db->sortedBy(field, true).size();
+            reportSuite(reusedNames[field - 1], records, 1, timeBest([&]() { sink += db->sortedBy(field, true).size(); }));
+        }
+
+        // runQuery shapes: index probe, narrow index range, prefix, full scan, aggregate
+        static const struct { const char* name; const char* text; } queries[] = {
+            { "query_ssn", "SELECT * FROM employees WHERE ssn = '387-42-0489'" },
+            { "query_salary_range", "SELECT * FROM employees WHERE salary BETWEEN 50000 AND 50100" },
+            { "query_lastname_prefix", "SELECT id FROM employees WHERE lastName LIKE 'Ma%' AND age < 20" },
+            { "query_scan", "SELECT id FROM employees WHERE age > 60 OR firstName = 'Mary'" },
+            { "query_order_limit", "SELECT * FROM employees WHERE age = 40 ORDER BY salary DESC LIMIT 10" },
+            { "query_group_by", "SELECT lastName, COUNT(*), AVG(salary) FROM employees GROUP BY lastName" },
+        };
+        for (const auto& query : queries) {
+            reportSuite(query.name, records, 1, timeBest([&]() {
+                QueryResult result = db->query(query.text);
+                sink += result.size() + result.aggregates().rows.size();
+            }));
+        }
+
+        db.reset();
+        removeDatabase();
+        std::cerr << "checksum " << sink << "\n";
+    }
+
+    // Readers and one writer hammer the database for `seconds`; returns the
+    // number of bad rows the readers saw
+    std::size_t stress(EmployeeDB& db, std::size_t records, std::size_t readers, double seconds) {
+        std::atomic<bool> stop{ false };
+        std::atomic<std::size_t> reads{ 0 }, writes{ 0 }, bad{ 0 };
+        db.setCommitInterval(64);
+
+        std::vector<std::thread> threads;
+        for (std::size_t r = 0; r < readers; r++) {
+            threads.emplace_back([&, r]() {
+                std::mt19937_64 rng(r + 1);
+                std::size_t done = 0, wrong = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    switch (rng() % 8) {
+                    case 0: {
+                        int age = static_cast<int>(18 + rng() % 50);
+                        QueryResult rows = db.query("SELECT * FROM employees WHERE age = " + std::to_string(age) + " LIMIT 200");
+                        for (const Employee& emp : rows) {
+                            wrong += !isGenerated(emp) || emp.age != age;
+                        }
+                        break;
+                    }
+                    case 1: {
+                        QueryResult rows = db.query("SELECT * FROM employees WHERE salary BETWEEN 50000 AND 50100");
+                        for (const Employee& emp : rows) {
+                            wrong += !isGenerated(emp) || emp.salary < 50000 || emp.salary > 50100;
+                        }
+                        break;
+                    }
+                    case 2: {
+                        if (rng() % 16 != 0) {
+                            break;          // Sorts are rare next to lookups
+                        }
+                        QueryResult rows = db.sortedBy(2, true);
+                        for (std::size_t i = 0; i < rows.size(); i++) {
+                            wrong += !isGenerated(rows[i]) || (i > 0 && rows[i - 1].age > rows[i].age);
+                        }
+                        break;
+                    }
+                    default: {
+                        int id = static_cast<int>(1 + rng() % (records + writes.load()));
+                        std::optional<Employee> emp = db.findById(id);
+                        wrong += emp && (emp->id != id || !isGenerated(*emp));
+                        break;
+                    }
+                    }
+                    done++;
+                }
+                reads += done;
+                bad += wrong;
+            });
+        }
+        threads.emplace_back([&]() {
+            std::mt19937_64 rng(0);
+            std::size_t next = records;     // Continues the generated SSN sequence
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (rng() % 4 == 0) {
+                    db.erase(static_cast<int>(1 + rng() % (next + 1)));
+                }
+                else {
+                    db.insert(makeEmployee(next++, rng()));
+                }
+                writes++;
+            }
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stop = true;
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        db.sync();
+
+        std::printf("stress_reads,%zu,%zu,%.0f\n", readers, records, static_cast<double>(reads) / elapsed);
+        std::printf("stress_writes,%zu,%zu,%.0f\n", readers, records, static_cast<double>(writes) / elapsed);
+        return bad;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 && !std::isdigit(static_cast<unsigned char>(argv[1][0])) ? argv[1] : "";
+    if (mode == "generate") {
+        // Writes to the given path, so it runs in the current directory
+        if (argc < 4) {
+            std::cerr << "Usage: benchmark generate records path\n";
+            return 1;
+        }
+        try {
+            generate(argv[3], std::strtoull(argv[2], nullptr, 10));
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    if (!mode.empty() && mode != "stress" && mode != "suite") {
+        std::cerr << "Unknown mode '" << mode << "'\n";
+        return 1;
+    }
+    bool stressMode = mode == "stress";
+    int arg = mode.empty() ? 1 : 2;
+    std::size_t records = argc > arg ? std::strtoull(argv[arg], nullptr, 10) : 2000000;
+    std::size_t maxThreads = argc > arg + 1 ? std::strtoull(argv[arg + 1], nullptr, 10) : std::thread::hardware_concurrency();
+    double seconds = argc > arg + 2 ? std::strtod(argv[arg + 2], nullptr) : 5.0;
+    if (maxThreads == 0) {
+        maxThreads = 1;
+    }
+    int status = 0;
+
+    char dir[] = "/tmp/employeedb-bench-XXXXXX";
+    if (!::mkdtemp(dir) || ::chdir(dir) != 0) {
+        std::cerr << "Cannot create a temp directory\n";
+        return 1;
+    }
+
+    try {
+        if (mode == "suite") {
+            std::size_t maxRecords = argc > 2 ? records : 1000000;
+            std::size_t minRecords = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1000;
+            std::cout << "operation,records,ops,seconds,ops_per_second\n";
+            for (std::size_t n = std::max<std::size_t>(minRecords, 1); n <= maxRecords; n *= 10) {
+                suite(n);
+            }
+        }
+        else {
+            generate("employees.dat", records);
+            EmployeeDB db;
+
+            if (stressMode) {
+                std::cout << "operation,readers,records,ops_per_second\n";
+                std::size_t bad = stress(db, records, maxThreads, seconds);
+                if (bad > 0) {
+                    std::cerr << bad << " inconsistent rows read\n";
+                    status = 1;
+                }
+            }
+            else {
+                scaling(db, records, maxThreads);
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        status = 1;
+    }
+
+    removeDatabase();
+    ::chdir("/");
+    ::rmdir(dir);
+    return status;
+}
@@ -0,0 +1,42 @@
+#include "bloom_filter.h"
+#include <algorithm>
+
+void BloomFilter::reset(std::size_t expectedKeys) {
+    expected = expectedKeys;
+    keys = 0;
+    std::size_t bits = std::max<std::size_t>(expectedKeys, 1) * BITS_PER_KEY;
+    blockCount = (bits + BLOCK_WORDS * 64 - 1) / (BLOCK_WORDS * 64);
+    words.assign(blockCount * BLOCK_WORDS, 0);
+}
+
+// splitmix64 finalizer: spreads nearby keys (e.g. consecutive SSNs) over all bits
+std::uint64_t BloomFilter::mix(std::uint64_t key) {
+    key += 0x9E3779B97F4A7C15ull;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+    return key ^ (key >> 31);
+}
+
+// One hash supplies seven 9-bit positions inside the block, a second one
+// picks the block
+void BloomFilter::add(std::uint64_t key) {
+    std::uint64_t hash = mix(key);
+    std::uint64_t* block = &words[(mix(hash) % blockCount) * BLOCK_WORDS];
+    for (int i = 0; i < PROBES; i++) {
+        unsigned bit = static_cast<unsigned>(hash >> (9 * i)) & 511u;
+        block[bit >> 6] |= 1ull << (bit & 63);
+    }
+    keys++;
+}
+
+bool BloomFilter::mightContain(std::uint64_t key) const {
+    std::uint64_t hash = mix(key);
+    const std::uint64_t* block = &words[(mix(hash) % blockCount) * BLOCK_WORDS];
+    for (int i = 0; i < PROBES; i++) {
+        unsigned bit = static_cast<unsigned>(hash >> (9 * i)) & 511u;
+        if (!(block[bit >> 6] & (1ull << (bit & 63)))) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,39 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// In-memory blocked Bloom filter over 64-bit keys. All probe bits of a key
+// fall in one 64-byte block, so a lookup touches a single cache line.
+// A negative answer is exact; a positive one may be a false hit (about 1%
+// at the sized capacity), so callers confirm positives elsewhere.
+// Keys cannot be removed: the owner rebuilds the filter instead.
+class BloomFilter {
+public:
+    explicit BloomFilter(std::size_t expectedKeys = 0) { reset(expectedKeys); }
+
+    // Empties the filter and sizes it for expectedKeys keys
+    void reset(std::size_t expectedKeys);
+
+    void add(std::uint64_t key);
+    bool mightContain(std::uint64_t key) const;
+
+    std::size_t size() const { return keys; }            // Keys added since the last reset
+    std::size_t capacity() const { return expected; }    // Keys it was sized for
+
+private:
+    static const std::size_t BITS_PER_KEY = 10;
+    static const int PROBES = 7;
+    static const std::size_t BLOCK_WORDS = 8;           // 512-bit blocks
+
+    std::vector<std::uint64_t> words;
+    std::size_t blockCount = 1;
+    std::size_t expected = 0;
+    std::size_t keys = 0;
+
+    static std::uint64_t mix(std::uint64_t key);
+};
+
+#endif
@@ -0,0 +1,441 @@
+#include "bplus_tree.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    const char INDEX_MAGIC[8] = { 'E', 'M', 'P', 'B', 'T', 'R', 'E', '1' };
+    const std::size_t NODE_HEADER = 8;      // leaf flag, count and sibling link
+
+    // Rounds up to the next multiple of 8 so value arrays stay aligned
+    std::size_t align8(std::size_t n) {
+        return (n + 7) & ~static_cast<std::size_t>(7);
+    }
+}
+
+// Opens an existing index file or creates a new, empty one
+BPlusTree::BPlusTree(const std::string& path, std::size_t keySize, BufferPool* pool)
+    : path(path), keyBytes(keySize), pool(pool) {
+    static_assert(PAGE_SIZE == BufferPool::PAGE_SIZE, "tree nodes must fill whole pool pages");
+    // Work out how many keys fit in a leaf (key + 64-bit value)
+    leafCapacity = (PAGE_SIZE - NODE_HEADER) / (keyBytes + sizeof(std::uint64_t));
+    while (NODE_HEADER + align8(leafCapacity * keyBytes) + leafCapacity * sizeof(std::uint64_t) > PAGE_SIZE) {
+        leafCapacity--;
+    }
+    // ...and in an internal node (key + 32-bit child page, plus one extra child)
+    innerCapacity = (PAGE_SIZE - NODE_HEADER - sizeof(std::uint32_t)) / (keyBytes + sizeof(std::uint32_t));
+    while (NODE_HEADER + align8(innerCapacity * keyBytes) + (innerCapacity + 1) * sizeof(std::uint32_t) > PAGE_SIZE) {
+        innerCapacity--;
+    }
+    if (leafCapacity < 3 || innerCapacity < 3) {
+        throw std::invalid_argument("B+tree key size too large for page");
+    }
+
+    if (!this->pool) {
+        ownPool = std::make_unique<BufferPool>(OWN_POOL_BYTES);
+        this->pool = ownPool.get();
+    }
+    poolFile = this->pool->attach(
+        [this](std::uint32_t pageNo, char* data) { readFromFile(pageNo, data); },
+        [this](std::uint32_t pageNo, const char* data) { writeToFile(pageNo, data); });
+
+    file.open(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (file && file.read(reinterpret_cast<char*>(&header), sizeof(Header)) &&
+        std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+        header.keySize == keyBytes) {
+        return;         // Valid existing index
+    }
+
+    // Missing, corrupt or incompatible file: start over with an empty tree
+    createEmpty();
+}
+
+BPlusTree::~BPlusTree() {
+    if (file.is_open()) {
+        flush();
+    }
+    pool->detach(poolFile);
+}
+
+// Truncates the file and writes a header plus a single empty root leaf
+void BPlusTree::createEmpty() {
+    pool->discard(poolFile);        // Cached pages belong to the old contents
+    if (file.is_open()) {
+        file.close();
+    }
+    file.open(path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Cannot create index file " + path);
+    }
+
+    std::memset(&header, 0, sizeof(Header));
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.keySize = static_cast<std::uint32_t>(keyBytes);
+    header.pageCount = 1;       // Page 0 holds the header
+
+    Page root;
+    std::memset(root.data, 0, PAGE_SIZE);
+    setNode(root, true, 0, 0);
+    header.rootPage = allocatePage();
+    header.height = 1;
+    writePage(header.rootPage, root);
+    flush();
+}
+
+void BPlusTree::readPage(std::uint32_t pageNo, Page& page) {
+    pool->read(poolFile, pageNo, page.data);
+}
+
+void BPlusTree::writePage(std::uint32_t pageNo, const Page& page) {
+    pool->write(poolFile, pageNo, page.data);
+}
+
+// Page I/O for the pool: cache misses and write-backs
+void BPlusTree::readFromFile(std::uint32_t pageNo, char* data) {
+    std::lock_guard<std::mutex> guard(fileLock);
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(pageNo) * PAGE_SIZE);
+    if (!file.read(data, PAGE_SIZE)) {
+        throw std::runtime_error("Short read in index file " + path);
+    }
+    ioCounters.read(PAGE_SIZE);
+}
+
+void BPlusTree::writeToFile(std::uint32_t pageNo, const char* data) {
+    std::lock_guard<std::mutex> guard(fileLock);
+    file.clear();
+    file.seekp(static_cast<std::streamoff>(pageNo) * PAGE_SIZE);
+    file.write(data, PAGE_SIZE);
+    ioCounters.wrote(PAGE_SIZE);
+}
+
+std::uint32_t BPlusTree::allocatePage() {
+    return header.pageCount++;      // New pages are always appended
+}
+
+// The header bypasses the pool: it is only written once the nodes it
+// describes are in the file
+void BPlusTree::writeHeader() {
+    // Pad the header out to a full page so the first node starts at PAGE_SIZE
+    Page page;
+    std::memset(page.data, 0, PAGE_SIZE);
+    std::memcpy(page.data, &header, sizeof(Header));
+    writeToFile(0, page.data);
+}
+
+void BPlusTree::flush() {
+    pool->writeBack(poolFile);
+    writeHeader();
+    std::lock_guard<std::mutex> guard(fileLock);
+    file.flush();
+}
+
+// ---- Raw node accessors ----
+
+bool BPlusTree::isLeaf(const Page& page) {
+    return page.data[0] != 0;
+}
+
+std::uint16_t BPlusTree::count(const Page& page) {
+    std::uint16_t n;
+    std::memcpy(&n, page.data + 2, sizeof(n));
+    return n;
+}
+
+std::uint32_t BPlusTree::nextLeaf(const Page& page) {
+    std::uint32_t next;
+    std::memcpy(&next, page.data + 4, sizeof(next));
+    return next;
+}
+
+void BPlusTree::setNode(Page& page, bool leaf, std::uint16_t count, std::uint32_t next) {
+    page.data[0] = leaf ? 1 : 0;
+    page.data[1] = 0;
+    std::memcpy(page.data + 2, &count, sizeof(count));
+    std::memcpy(page.data + 4, &next, sizeof(next));
+}
+
+char* BPlusTree::keyAt(Page& page, std::size_t i) const {
+    return page.data + NODE_HEADER + i * keyBytes;
+}
+
+const char* BPlusTree::keyAt(const Page& page, std::size_t i) const {
+    return page.data + NODE_HEADER + i * keyBytes;
+}
+
+std::uint64_t* BPlusTree::valueAt(Page& page, std::size_t i) const {
+    return reinterpret_cast<std::uint64_t*>(page.data + NODE_HEADER + align8(leafCapacity * keyBytes)) + i;
+}
+
+std::uint32_t* BPlusTree::childAt(Page& page, std::size_t i) const {
+    return reinterpret_cast<std::uint32_t*>(page.data + NODE_HEADER + align8(innerCapacity * keyBytes)) + i;
+}
+
+// Binary search for the first key that is >= key
+std::size_t BPlusTree::lowerBound(const Page& page, const void* key) const {
+    std::size_t left = 0, right = count(page);
+    while (left < right) {
+        std::size_t mid = left + (right - left) / 2;
+        if (std::memcmp(keyAt(page, mid), key, keyBytes) < 0) {
+            left = mid + 1;
+        }
+        else {
+            right = mid;
+        }
+    }
+    return left;
+}
+
+// Internal nodes route keys equal to a separator to the right-hand child
+std::size_t BPlusTree::childIndex(const Page& page, const void* key) const {
+    std::size_t left = 0, right = count(page);
+    while (left < right) {
+        std::size_t mid = left + (right - left) / 2;
+        if (std::memcmp(keyAt(page, mid), key, keyBytes) <= 0) {
+            left = mid + 1;
+        }
+        else {
+            right = mid;
+        }
+    }
+    return left;
+}
+
+// Walks from the root to the leaf that would contain key (leftmost leaf if key is null)
+std::uint32_t BPlusTree::findLeaf(const void* key, Page& leaf) {
+    std::uint32_t pageNo = header.rootPage;
+    readPage(pageNo, leaf);
+    while (!isLeaf(leaf)) {
+        std::size_t i = key ? childIndex(leaf, key) : 0;
+        pageNo = *childAt(leaf, i);
+        readPage(pageNo, leaf);
+    }
+    return pageNo;
+}
+
+// ---- Public operations ----
+
+bool BPlusTree::find(const void* key, std::uint64_t& value) {
+    Page leaf;
+    findLeaf(key, leaf);
+    std::size_t pos = lowerBound(leaf, key);
+    if (pos < count(leaf) && std::memcmp(keyAt(leaf, pos), key, keyBytes) == 0) {
+        value = *valueAt(leaf, pos);
+        return true;
+    }
+    return false;
+}
+
+// Splits the full child at parent[index] in two and links the new node into parent
+void BPlusTree::splitChild(Page& parent, std::uint32_t parentNo, std::size_t index,
+    Page& child, std::uint32_t childNo) {
+    Page sibling;
+    std::memset(sibling.data, 0, PAGE_SIZE);
+    std::uint32_t siblingNo = allocatePage();
+    std::uint16_t n = count(child);
+    std::vector<char> separator(keyBytes);
+
+    if (isLeaf(child)) {
+        // Upper half moves to the new leaf; its first key is copied up
+        std::uint16_t mid = n / 2;
+        std::uint16_t moved = n - mid;
+        setNode(sibling, true, moved, nextLeaf(child));
+        std::memcpy(keyAt(sibling, 0), keyAt(child, mid), moved * keyBytes);
+        std::memcpy(valueAt(sibling, 0), valueAt(child, mid), moved * sizeof(std::uint64_t));
+        std::memcpy(separator.data(), keyAt(sibling, 0), keyBytes);
+        setNode(child, true, mid, siblingNo);
+    }
+    else {
+        // Middle key moves up; keys and children to its right move to the new node
+        std::uint16_t mid = n / 2;
+        std::uint16_t moved = n - mid - 1;
+        setNode(sibling, false, moved, 0);
+        std::memcpy(separator.data(), keyAt(child, mid), keyBytes);
+        std::memcpy(keyAt(sibling, 0), keyAt(child, mid + 1), moved * keyBytes);
+        std::memcpy(childAt(sibling, 0), childAt(child, mid + 1), (moved + 1) * sizeof(std::uint32_t));
+        setNode(child, false, mid, 0);
+    }
+
+    // Make room in the parent for the separator and the new child pointer
+    std::uint16_t pn = count(parent);
+    std::memmove(keyAt(parent, index + 1), keyAt(parent, index), (pn - index) * keyBytes);
+    std::memmove(childAt(parent, index + 2), childAt(parent, index + 1), (pn - index) * sizeof(std::uint32_t));
+    std::memcpy(keyAt(parent, index), separator.data(), keyBytes);
+    *childAt(parent, index + 1) = siblingNo;
+    setNode(parent, false, pn + 1, 0);
+
+    writePage(childNo, child);
+    writePage(siblingNo, sibling);
+    writePage(parentNo, parent);
+}
+
+// Top-down insert: full nodes are split on the way down so the leaf always has room
+void BPlusTree::insert(const void* key, std::uint64_t value) {
+    std::uint32_t nodeNo = header.rootPage;
+    Page node;
+    readPage(nodeNo, node);
+
+    // Grow the tree by one level when the root is full
+    std::size_t rootCapacity = isLeaf(node) ? leafCapacity : innerCapacity;
+    if (count(node) >= rootCapacity) {
+        Page newRoot;
+        std::memset(newRoot.data, 0, PAGE_SIZE);
+        std::uint32_t newRootNo = allocatePage();
+        setNode(newRoot, false, 0, 0);
+        *childAt(newRoot, 0) = nodeNo;
+        splitChild(newRoot, newRootNo, 0, node, nodeNo);
+        header.rootPage = newRootNo;
+        header.height++;
+        nodeNo = newRootNo;
+        node = newRoot;
+    }
+
+    while (!isLeaf(node)) {
+        std::size_t i = childIndex(node, key);
+        std::uint32_t childNo = *childAt(node, i);
+        Page child;
+        readPage(childNo, child);
+
+        std::size_t capacity = isLeaf(child) ? leafCapacity : innerCapacity;
+        if (count(child) >= capacity) {
+            splitChild(node, nodeNo, i, child, childNo);
+            // The key may now belong in the new right-hand sibling
+            if (std::memcmp(key, keyAt(node, i), keyBytes) >= 0) {
+                i++;
+            }
+            childNo = *childAt(node, i);
+            readPage(childNo, child);
+        }
+        nodeNo = childNo;
+        node = child;
+    }
+
+    std::uint16_t n = count(node);
+    std::size_t pos = lowerBound(node, key);
+    if (pos < n && std::memcmp(keyAt(node, pos), key, keyBytes) == 0) {
+        *valueAt(node, pos) = value;        // Existing key: overwrite in place
+    }
+    else {
+        std::memmove(keyAt(node, pos + 1), keyAt(node, pos), (n - pos) * keyBytes);
+        std::memmove(valueAt(node, pos + 1), valueAt(node, pos), (n - pos) * sizeof(std::uint64_t));
+        std::memcpy(keyAt(node, pos), key, keyBytes);
+        *valueAt(node, pos) = value;
+        setNode(node, true, n + 1, nextLeaf(node));
+        header.entryCount++;
+    }
+    writePage(nodeNo, node);
+}
+
+// Removes a key from its leaf. Underfull leaves are left in place; lookups
+// stay correct because separators in internal nodes are never removed.
+bool BPlusTree::erase(const void* key) {
+    Page leaf;
+    std::uint32_t leafNo = findLeaf(key, leaf);
+    std::uint16_t n = count(leaf);
+    std::size_t pos = lowerBound(leaf, key);
+    if (pos >= n || std::memcmp(keyAt(leaf, pos), key, keyBytes) != 0) {
+        return false;
+    }
+
+    std::memmove(keyAt(leaf, pos), keyAt(leaf, pos + 1), (n - pos - 1) * keyBytes);
+    std::memmove(valueAt(leaf, pos), valueAt(leaf, pos + 1), (n - pos - 1) * sizeof(std::uint64_t));
+    setNode(leaf, true, n - 1, nextLeaf(leaf));
+    writePage(leafNo, leaf);
+
+    header.entryCount--;
+    return true;
+}
+
+// Range scan following the leaf sibling chain
+void BPlusTree::scan(const void* fromKey,
+    const std::function<bool(const char* key, std::uint64_t value)>& visit) {
+    Page leaf;
+    findLeaf(fromKey, leaf);
+    std::size_t pos = fromKey ? lowerBound(leaf, fromKey) : 0;
+
+    while (true) {
+        std::uint16_t n = count(leaf);
+        for (; pos < n; pos++) {
+            if (!visit(keyAt(leaf, pos), *valueAt(leaf, pos))) {
+                return;
+            }
+        }
+        std::uint32_t next = nextLeaf(leaf);
+        if (next == 0) {
+            return;         // Page 0 is the header, so 0 marks the last leaf
+        }
+        readPage(next, leaf);
+        pos = 0;
+    }
+}
+
+// Builds the tree bottom-up from sorted input, leaving some slack in every node
+void BPlusTree::bulkLoad(const char* keys, const std::uint64_t* values, std::size_t total) {
+    std::uint64_t savedStamp = header.stamp;
+    createEmpty();
+    header.stamp = savedStamp;
+    if (total == 0) {
+        flush();
+        return;
+    }
+
+    // Fill nodes to ~90% so the first few inserts do not split immediately
+    std::size_t leafFill = leafCapacity - leafCapacity / 10;
+    std::size_t innerFill = innerCapacity - innerCapacity / 10;
+
+    // Level 0: leaves. Reuse the empty root page for the first leaf.
+    std::vector<std::uint32_t> levelPages;
+    std::vector<char> levelKeys;         // First key of each node on the level
+    std::size_t leafCount = (total + leafFill - 1) / leafFill;
+    for (std::size_t l = 0; l < leafCount; l++) {
+        std::size_t begin = l * leafFill;
+        std::uint32_t pageNo = (l == 0) ? header.rootPage : allocatePage();
+        levelPages.push_back(pageNo);
+        levelKeys.insert(levelKeys.end(), keys + begin * keyBytes, keys + (begin + 1) * keyBytes);
+    }
+    for (std::size_t l = 0; l < leafCount; l++) {
+        std::size_t begin = l * leafFill;
+        std::size_t n = std::min(leafFill, total - begin);
+        Page leaf;
+        std::memset(leaf.data, 0, PAGE_SIZE);
+        std::uint32_t next = (l + 1 < leafCount) ? levelPages[l + 1] : 0;
+        setNode(leaf, true, static_cast<std::uint16_t>(n), next);
+        std::memcpy(keyAt(leaf, 0), keys + begin * keyBytes, n * keyBytes);
+        std::memcpy(valueAt(leaf, 0), values + begin, n * sizeof(std::uint64_t));
+        writePage(levelPages[l], leaf);
+    }
+
+    // Upper levels: group children under new internal nodes until one root remains
+    std::uint32_t height = 1;
+    while (levelPages.size() > 1) {
+        std::vector<std::uint32_t> parentPages;
+        std::vector<char> parentKeys;
+        std::size_t children = innerFill + 1;
+        for (std::size_t begin = 0; begin < levelPages.size(); begin += children) {
+            std::size_t n = std::min(children, levelPages.size() - begin);
+            Page inner;
+            std::memset(inner.data, 0, PAGE_SIZE);
+            setNode(inner, false, static_cast<std::uint16_t>(n - 1), 0);
+            for (std::size_t c = 0; c < n; c++) {
+                *childAt(inner, c) = levelPages[begin + c];
+                if (c > 0) {
+                    std::memcpy(keyAt(inner, c - 1), &levelKeys[(begin + c) * keyBytes], keyBytes);
+                }
+            }
+            std::uint32_t pageNo = allocatePage();
+            writePage(pageNo, inner);
+            parentPages.push_back(pageNo);
+            parentKeys.insert(parentKeys.end(), levelKeys.begin() + begin * keyBytes,
+                levelKeys.begin() + (begin + 1) * keyBytes);
+        }
+        levelPages.swap(parentPages);
+        levelKeys.swap(parentKeys);
+        height++;
+    }
+
+    header.rootPage = levelPages[0];
+    header.height = height;
+    header.entryCount = total;
+    flush();
+}
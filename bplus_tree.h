@@ -0,0 +1,121 @@
+#ifndef BPLUS_TREE_H
+#define BPLUS_TREE_H
+
+#include "buffer_pool.h"
+#include "metrics.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Disk-resident B+tree mapping fixed-width keys to 64-bit values.
+// Keys are compared byte-wise (memcmp), so callers encode them big-endian
+// to get numeric ordering. Every node occupies one page of the index file.
+// Lookups and scans may run concurrently with each other; modifications
+// need exclusive access.
+//
+// Node pages are read and written through a BufferPool, which may be shared
+// with other trees. Modified nodes and the header stay in memory until
+// flush(), which writes the nodes before the header, so the header on disk
+// (and its stamp) never describes nodes that have not been written.
+class BPlusTree {
+public:
+    static const std::size_t PAGE_SIZE = 4096;     // Bytes per node page
+
+    // Opens (or creates) the index stored at path with the given key width.
+    // Without a pool the tree caches its pages in a small pool of its own.
+    BPlusTree(const std::string& path, std::size_t keySize, BufferPool* pool = nullptr);
+    ~BPlusTree();
+
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    // Looks up a key; returns true and fills value when present
+    bool find(const void* key, std::uint64_t& value);
+
+    // Inserts a key or overwrites the value of an existing key
+    void insert(const void* key, std::uint64_t value);
+
+    // Removes a key; returns false when the key was not present
+    bool erase(const void* key);
+
+    // Visits entries in key order starting at the first key >= fromKey
+    // (or at the smallest key when fromKey is null). The visitor returns
+    // false to stop the scan early.
+    void scan(const void* fromKey,
+        const std::function<bool(const char* key, std::uint64_t value)>& visit);
+
+    // Replaces the whole tree with keys/values that are already sorted and unique
+    void bulkLoad(const char* keys, const std::uint64_t* values, std::size_t count);
+
+    // Caller-defined stamp used to detect an index that is out of date
+    // (saved with the header by flush())
+    std::uint64_t stamp() const { return header.stamp; }
+    void setStamp(std::uint64_t value) { header.stamp = value; }
+
+    std::uint64_t size() const { return header.entryCount; }    // Number of keys stored
+    std::size_t keySize() const { return keyBytes; }
+
+    void flush();        // Writes modified nodes, then the header, and flushes the file stream
+
+    const IOCounters& io() const { return ioCounters; }     // Page reads and writes reaching the file
+
+private:
+    // Fixed header stored at the start of page 0
+    struct Header {
+        char magic[8];
+        std::uint32_t keySize;
+        std::uint32_t rootPage;
+        std::uint32_t pageCount;
+        std::uint32_t height;
+        std::uint64_t entryCount;
+        std::uint64_t stamp;
+    };
+
+    // In-memory copy of one node page
+    struct Page {
+        alignas(8) char data[PAGE_SIZE];
+    };
+
+    std::string path;
+    std::size_t keyBytes;
+    std::size_t leafCapacity;        // Max keys in a leaf node
+    std::size_t innerCapacity;       // Max keys in an internal node
+    std::fstream file;
+    std::mutex fileLock;             // Concurrent page reads share the stream's position
+    Header header;
+    IOCounters ioCounters;
+    std::unique_ptr<BufferPool> ownPool;
+    BufferPool* pool;                // Cache every node page goes through
+    std::uint32_t poolFile;          // This tree's handle in the pool
+
+    static constexpr std::size_t OWN_POOL_BYTES = 1 << 20;
+
+    void createEmpty();
+    void readPage(std::uint32_t pageNo, Page& page);
+    void writePage(std::uint32_t pageNo, const Page& page);
+    void readFromFile(std::uint32_t pageNo, char* data);
+    void writeToFile(std::uint32_t pageNo, const char* data);
+    std::uint32_t allocatePage();
+    void writeHeader();
+
+    // Node accessors operating on a raw page
+    static bool isLeaf(const Page& page);
+    static std::uint16_t count(const Page& page);
+    static std::uint32_t nextLeaf(const Page& page);
+    static void setNode(Page& page, bool leaf, std::uint16_t count, std::uint32_t next);
+    char* keyAt(Page& page, std::size_t i) const;
+    const char* keyAt(const Page& page, std::size_t i) const;
+    std::uint64_t* valueAt(Page& page, std::size_t i) const;
+    std::uint32_t* childAt(Page& page, std::size_t i) const;
+
+    std::size_t lowerBound(const Page& page, const void* key) const;     // First key >= key
+    std::size_t childIndex(const Page& page, const void* key) const;     // Child to descend into
+    std::uint32_t findLeaf(const void* key, Page& leaf);
+    void splitChild(Page& parent, std::uint32_t parentNo, std::size_t index, Page& child, std::uint32_t childNo);
+};
+
+#endif
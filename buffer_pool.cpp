@@ -0,0 +1,210 @@
+#include "buffer_pool.h"
+#include <algorithm>
+#include <cstring>
+
+BufferPool::BufferPool(std::size_t bytes) {
+    resize(bytes);
+}
+
+// Splits the budget between the shards; callers hold every shard lock (or
+// are the constructor)
+void BufferPool::resize(std::size_t bytes) {
+    std::size_t pages = std::max(MIN_PAGES, bytes / PAGE_SIZE);
+    for (std::size_t s = 0; s < SHARDS; s++) {
+        shards[s].capacityPages = pages / SHARDS + (s < pages % SHARDS ? 1 : 0);
+    }
+}
+
+// Pages of one file are spread over the shards by a multiplicative hash
+BufferPool::Shard& BufferPool::shardOf(std::uint64_t key) {
+    return shards[static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) % SHARDS];
+}
+
+BufferPool::File& BufferPool::fileOf(std::uint64_t key) {
+    std::lock_guard<std::mutex> guard(filesLock);
+    return *files[static_cast<std::uint32_t>(key >> 32)];
+}
+
+std::uint32_t BufferPool::attach(PageReader reader, PageWriter writer) {
+    std::lock_guard<std::mutex> guard(filesLock);
+    files.push_back(std::make_unique<File>(File{ std::move(reader), std::move(writer) }));
+    return static_cast<std::uint32_t>(files.size() - 1);
+}
+
+void BufferPool::detach(std::uint32_t file) {
+    drop(file, true);
+    std::lock_guard<std::mutex> guard(filesLock);
+    *files[file] = File{};
+}
+
+void BufferPool::read(std::uint32_t file, std::uint32_t pageNo, char* data) {
+    std::uint64_t key = keyOf(file, pageNo);
+    Shard& shard = shardOf(key);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    auto found = shard.lookup.find(key);
+    if (found != shard.lookup.end()) {
+        Frame& frame = shard.frames[found->second];
+        frame.referenced = true;
+        std::memcpy(data, frame.data.get(), PAGE_SIZE);
+        shard.counts.hits++;
+        return;
+    }
+    shard.counts.misses++;
+    std::size_t index = frameFor(shard, key);
+    Frame& frame = shard.frames[index];
+    try {
+        fileOf(key).reader(pageNo, frame.data.get());
+    }
+    catch (...) {
+        shard.lookup.erase(key);        // Leave no half-read page behind
+        frame.used = false;
+        throw;
+    }
+    std::memcpy(data, frame.data.get(), PAGE_SIZE);
+}
+
+// The whole page is replaced, so a page that is not cached is never read first
+void BufferPool::write(std::uint32_t file, std::uint32_t pageNo, const char* data) {
+    std::uint64_t key = keyOf(file, pageNo);
+    Shard& shard = shardOf(key);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    auto found = shard.lookup.find(key);
+    std::size_t index = found != shard.lookup.end() ? found->second : frameFor(shard, key);
+    Frame& frame = shard.frames[index];
+    std::memcpy(frame.data.get(), data, PAGE_SIZE);
+    frame.dirty = true;
+    frame.referenced = true;
+}
+
+// Returns a frame of the shard registered under key: a fresh one while the
+// shard is still growing, otherwise the first page the clock hand finds
+// unreferenced (written back first if dirty)
+std::size_t BufferPool::frameFor(Shard& shard, std::uint64_t key) {
+    std::size_t index;
+    if (shard.frames.size() < shard.capacityPages) {
+        shard.frames.emplace_back();
+        shard.frames.back().data.reset(new char[PAGE_SIZE]);
+        index = shard.frames.size() - 1;
+    }
+    else {
+        while (true) {
+            Frame& frame = shard.frames[shard.hand];
+            index = shard.hand;
+            shard.hand = (shard.hand + 1) % shard.frames.size();
+            if (!frame.used) {
+                break;
+            }
+            if (frame.referenced) {
+                frame.referenced = false;   // Second chance
+                continue;
+            }
+            flushFrame(shard, frame);
+            shard.lookup.erase(frame.key);
+            shard.counts.evictions++;
+            break;
+        }
+    }
+    Frame& frame = shard.frames[index];
+    frame.key = key;
+    frame.used = true;
+    frame.dirty = false;
+    frame.referenced = true;
+    shard.lookup[key] = index;
+    return index;
+}
+
+void BufferPool::flushFrame(Shard& shard, Frame& frame) {
+    if (frame.dirty) {
+        fileOf(frame.key).writer(static_cast<std::uint32_t>(frame.key), frame.data.get());
+        frame.dirty = false;
+        shard.counts.writeBacks++;
+    }
+}
+
+// Locks every shard (always in the same order), so the file's dirty pages
+// from all of them are written in one sweep
+void BufferPool::writeBack(std::uint32_t file) {
+    struct Dirty {
+        Shard* shard;
+        Frame* frame;
+    };
+    std::vector<std::unique_lock<std::mutex>> guards;
+    guards.reserve(SHARDS);
+    std::vector<Dirty> dirty;
+    for (Shard& shard : shards) {
+        guards.emplace_back(shard.lock);
+        for (Frame& frame : shard.frames) {
+            if (frame.used && frame.dirty && (frame.key >> 32) == file) {
+                dirty.push_back(Dirty{ &shard, &frame });
+            }
+        }
+    }
+    // Page order turns the write-back into one forward sweep over the file
+    std::sort(dirty.begin(), dirty.end(), [](const Dirty& a, const Dirty& b) {
+        return a.frame->key < b.frame->key;
+    });
+    for (const Dirty& page : dirty) {
+        flushFrame(*page.shard, *page.frame);
+    }
+}
+
+void BufferPool::discard(std::uint32_t file) {
+    drop(file, false);
+}
+
+// Frees every frame of one file, writing dirty ones back first when save is set
+void BufferPool::drop(std::uint32_t file, bool save) {
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        for (Frame& frame : shard.frames) {
+            if (frame.used && (frame.key >> 32) == file) {
+                if (save) {
+                    flushFrame(shard, frame);
+                }
+                shard.lookup.erase(frame.key);
+                frame.used = false;
+                frame.dirty = false;
+            }
+        }
+    }
+}
+
+void BufferPool::setCapacity(std::size_t bytes) {
+    std::vector<std::unique_lock<std::mutex>> guards;
+    guards.reserve(SHARDS);
+    for (Shard& shard : shards) {
+        guards.emplace_back(shard.lock);
+        for (Frame& frame : shard.frames) {
+            if (frame.used) {
+                flushFrame(shard, frame);
+            }
+        }
+        shard.frames.clear();
+        shard.lookup.clear();
+        shard.hand = 0;
+    }
+    resize(bytes);
+}
+
+std::size_t BufferPool::capacity() const {
+    std::size_t pages = 0;
+    for (const Shard& shard : shards) {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        pages += shard.capacityPages;
+    }
+    return pages * PAGE_SIZE;
+}
+
+CacheStats BufferPool::stats() const {
+    CacheStats total;
+    for (const Shard& shard : shards) {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        total.hits += shard.counts.hits;
+        total.misses += shard.counts.misses;
+        total.evictions += shard.counts.evictions;
+        total.writeBacks += shard.counts.writeBacks;
+        total.pages += shard.lookup.size();
+        total.capacityPages += shard.capacityPages;
+    }
+    return total;
+}
@@ -0,0 +1,97 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include "metrics.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Fixed-budget cache of 4 KiB file pages shared by several files (the
+// B+tree indexes). Pages are copied in and out, so callers never hold
+// pointers into the pool. Writes only mark the cached page dirty; dirty
+// pages reach their file when evicted or on writeBack(). Eviction uses the
+// CLOCK algorithm: a hit sets the page's reference bit, and the clock hand
+// clears bits until it finds an unreferenced page.
+//
+// The pool is split into shards by page, each with its own lock, frames
+// and clock, so concurrent readers only contend when their pages land in
+// the same shard.
+//
+// The pool does no I/O of its own: each attached file supplies functions
+// that read and write one page. They are called with a shard locked and
+// must not call back into the pool.
+class BufferPool {
+public:
+    static const std::size_t PAGE_SIZE = 4096;
+    static constexpr std::size_t MIN_PAGES = 16;
+    static constexpr std::size_t SHARDS = 16;
+
+    using PageReader = std::function<void(std::uint32_t pageNo, char* data)>;
+    using PageWriter = std::function<void(std::uint32_t pageNo, const char* data)>;
+
+    explicit BufferPool(std::size_t bytes);
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // Registers a file and returns the handle used for its pages
+    std::uint32_t attach(PageReader reader, PageWriter writer);
+    void detach(std::uint32_t file);                 // Writes back and forgets the file's pages
+
+    void read(std::uint32_t file, std::uint32_t pageNo, char* data);
+    void write(std::uint32_t file, std::uint32_t pageNo, const char* data);
+    void writeBack(std::uint32_t file);              // Writes the file's dirty pages, in page order
+    void discard(std::uint32_t file);                // Forgets the file's pages without writing them
+
+    // Memory budget in bytes (at least MIN_PAGES pages), split evenly
+    // between the shards. Resizing writes back every dirty page and
+    // empties the pool.
+    void setCapacity(std::size_t bytes);
+    std::size_t capacity() const;
+
+    CacheStats stats() const;
+
+private:
+    struct Frame {
+        std::unique_ptr<char[]> data;
+        std::uint64_t key = 0;           // file << 32 | pageNo
+        bool used = false;
+        bool dirty = false;
+        bool referenced = false;
+    };
+
+    struct File {
+        PageReader reader;
+        PageWriter writer;
+    };
+
+    struct Shard {
+        mutable std::mutex lock;         // Guards everything below
+        std::size_t capacityPages = 0;
+        std::vector<Frame> frames;       // Grows up to capacityPages, then pages are evicted
+        std::unordered_map<std::uint64_t, std::size_t> lookup;     // Key -> frame
+        std::size_t hand = 0;            // CLOCK position
+        CacheStats counts;
+    };
+
+    std::array<Shard, SHARDS> shards;
+    std::mutex filesLock;                // Guards files; taken after a shard lock, never before
+    std::vector<std::unique_ptr<File>> files;        // Indexed by file handle
+
+    static std::uint64_t keyOf(std::uint32_t file, std::uint32_t pageNo) {
+        return (std::uint64_t(file) << 32) | pageNo;
+    }
+    Shard& shardOf(std::uint64_t key);
+    File& fileOf(std::uint64_t key);
+    void resize(std::size_t bytes);
+    std::size_t frameFor(Shard& shard, std::uint64_t key);
+    void flushFrame(Shard& shard, Frame& frame);
+    void drop(std::uint32_t file, bool save);
+};
+
+#endif
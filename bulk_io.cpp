@@ -0,0 +1,428 @@
+#include "employee.h"
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+
+// Bulk import/export: non-interactive loaders and streaming exporters
+
+namespace {
+    const std::size_t IO_CHUNK = 1 << 20;        // Read buffer size (1 MiB)
+    const std::size_t BATCH_RECORDS = 8192;      // Records appended per write
+
+    // Splits one CSV line into fields. Fields may be wrapped in double quotes,
+    // with "" standing for a literal quote inside them.
+    void splitCSVLine(const char* line, std::size_t length, std::vector<std::string>& fields) {
+        fields.clear();
+        std::size_t i = 0;
+        while (true) {
+            fields.emplace_back();
+            std::string& field = fields.back();
+            if (i < length && line[i] == '"') {
+                i++;
+                while (i < length) {
+                    if (line[i] == '"') {
+                        if (i + 1 < length && line[i + 1] == '"') {
+                            field += '"';
+                            i += 2;
+                            continue;
+                        }
+                        i++;
+                        break;
+                    }
+                    field += line[i++];
+                }
+                while (i < length && line[i] != ',') {
+                    i++;            // Ignore anything between the closing quote and the comma
+                }
+            }
+            else {
+                std::size_t start = i;
+                while (i < length && line[i] != ',') {
+                    i++;
+                }
+                field.assign(line + start, i - start);
+            }
+            if (i >= length) {
+                break;
+            }
+            i++;                    // Skip the comma
+        }
+    }
+
+    bool equalsIgnoreCase(const std::string& a, const char* b) {
+        if (a.size() != std::strlen(b)) {
+            return false;
+        }
+        for (std::size_t i = 0; i < a.size(); i++) {
+            if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Fills emp from firstName, lastName, ssn, salary, age; false if any field is invalid
+    bool parseEmployeeFields(const std::string* f, Employee& emp) {
+        if (f[0].size() > 20 || f[1].size() > 20 || f[2].size() != 11) {
+            return false;
+        }
+        std::memset(&emp, 0, sizeof(Employee));
+        std::memcpy(emp.firstName, f[0].data(), f[0].size());
+        std::memcpy(emp.lastName, f[1].data(), f[1].size());
+        std::memcpy(emp.ssn, f[2].data(), f[2].size());
+        if (!isValidSSN(emp.ssn)) {
+            return false;
+        }
+
+        // strtof also accepts "nan" and "inf" and saturates out-of-range values
+        char* end = nullptr;
+        errno = 0;
+        emp.salary = std::strtof(f[3].c_str(), &end);
+        if (f[3].empty() || *end != '\0' || errno == ERANGE || !std::isfinite(emp.salary)) {
+            return false;
+        }
+        long age = std::strtol(f[4].c_str(), &end, 10);
+        if (f[4].empty() || *end != '\0' || age < 0 || age > 200) {
+            return false;
+        }
+        emp.age = static_cast<int>(age);
+        emp.isDeleted = false;
+        return true;
+    }
+}
+
+// Writes a batch of new records with one log write, one data write and one
+// directory write
+void EmployeeDB::appendBatch(std::vector<Employee>& batch) {
+    if (batch.empty()) {
+        return;
+    }
+    // Batches are large enough to sync the log for each one
+    commitLog(wal.append(WriteAheadLog::Op::Insert, store.size(), batch.data(), batch.size()));
+    uncommitted = 0;
+    std::size_t first = store.appendBatch(batch.data(), batch.size());
+    directory.recordInsertBatch(batch.data(), batch.size(), first);
+    batch.clear();
+    maybeCheckpoint();
+}
+
+// Brings the SSN and secondary indexes up to date after records were bulk
+// appended from firstSlot on
+void EmployeeDB::indexAppended(std::size_t firstSlot) {
+    std::size_t added = store.size() - firstSlot;
+    if (added == 0) {
+        return;
+    }
+    if (added * 8 > store.size()) {
+        // Large loads: one sorted bulk build beats many single inserts
+        rebuildSSNIndex();
+        rebuildSecondaryIndexes();
+        return;
+    }
+    unsigned char key[4];
+    for (std::size_t slot = firstSlot; slot < store.size(); slot++) {
+        encodeSSNKey(packSSN(store.at(slot).ssn), key);
+        ssnIndex.insert(key, slot);
+        noteSSN(store.at(slot).ssn);
+        indexRecord(store.at(slot), slot);
+    }
+    ssnIndex.setStamp(store.size());
+}
+
+// Inserts are validated and collected into runs that are logged and appended
+// with one write each; an erase only ends the current run when it targets an
+// employee inserted in that run. The log is synced once, after the lock is
+// released, for the whole batch.
+std::vector<MutationResult> EmployeeDB::applyBatch(const std::vector<Mutation>& mutations) {
+    ScopedTimer timer(metrics, Operation::ApplyBatch);
+    std::vector<MutationResult> results(mutations.size());
+    std::uint64_t commitLsn = 0;
+    {
+        std::unique_lock<ReadWriteLock> guard(rwLock);
+        std::vector<Employee> run;
+        std::unordered_set<std::uint32_t> runSSNs;     // SSNs inserted by the current run
+        auto flushRun = [&]() {
+            if (run.empty()) {
+                return;
+            }
+            commitLsn = wal.append(WriteAheadLog::Op::Insert, store.size(), run.data(), run.size());
+            std::size_t first = store.appendBatch(run.data(), run.size());
+            directory.recordInsertBatch(run.data(), run.size(), first);
+            indexAppended(first);
+            run.clear();
+            runSSNs.clear();
+            maybeCheckpoint();
+        };
+
+        for (std::size_t i = 0; i < mutations.size(); i++) {
+            const Mutation& mutation = mutations[i];
+            MutationResult& result = results[i];
+            if (mutation.kind == Mutation::Kind::Erase) {
+                if (!run.empty() && mutation.id >= run.front().id) {
+                    flushRun();             // The employee may be in the pending run
+                }
+                std::uint64_t lsn;
+                if (eraseLocked(mutation.id, lsn)) {
+                    commitLsn = lsn;
+                    result.ok = true;
+                    result.id = mutation.id;
+                }
+                else {
+                    result.error = "Employee not found or already deleted";
+                }
+                continue;
+            }
+
+            Employee emp = mutation.emp;
+            emp.firstName[20] = '\0';
+            emp.lastName[20] = '\0';
+            emp.ssn[11] = '\0';
+            emp.isDeleted = false;
+            if (!isValidSSN(emp.ssn)) {
+                result.error = "Invalid SSN format";
+                continue;
+            }
+            if (!std::isfinite(emp.salary)) {
+                result.error = "Invalid salary";
+                continue;
+            }
+            if (ssnExists(emp.ssn) || !runSSNs.insert(packSSN(emp.ssn)).second) {
+                result.error = "SSN already exists in database";
+                continue;
+            }
+            emp.id = getNextId();
+            run.push_back(emp);
+            result.ok = true;
+            result.id = emp.id;
+            if (run.size() == BATCH_RECORDS) {
+                flushRun();
+            }
+        }
+        flushRun();
+        uncommitted = 0;            // The commit below covers every earlier mutation too
+        maybeCheckpoint();
+        maybeCompact();
+    }
+    if (commitLsn != 0) {
+        commitLog(commitLsn);
+    }
+    return results;
+}
+
+// Shared by the importers: skips SSNs that exist in the database or earlier
+// in the same import, assigns a fresh ID and queues the record for appending
+void EmployeeDB::stageImport(Employee& emp, ImportResult& result, std::unordered_set<std::uint32_t>& seen,
+    std::vector<Employee>& batch) {
+    if (ssnExists(emp.ssn) || !seen.insert(packSSN(emp.ssn)).second) {
+        result.duplicates++;
+        return;
+    }
+    emp.id = getNextId();
+    emp.isDeleted = false;
+    batch.push_back(emp);
+    result.imported++;
+    if (batch.size() == BATCH_RECORDS) {
+        appendBatch(batch);
+    }
+}
+
+// Loads firstName,lastName,ssn,salary,age rows (an optional leading id
+// column and a header line are accepted and ignored). New IDs are assigned.
+ImportResult EmployeeDB::importCSV(const std::string& path) {
+    ScopedTimer timer(metrics, Operation::Import);
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+
+    std::unique_lock<ReadWriteLock> guard(rwLock);     // One writer for the whole import
+    ImportResult result;
+    std::unordered_set<std::uint32_t> seen;     // SSNs added by this import
+    std::size_t firstSlot = store.size();
+    std::vector<Employee> batch;
+    batch.reserve(BATCH_RECORDS);
+    std::vector<std::string> fields;
+    std::vector<char> chunk(IO_CHUNK);
+    std::string pending;            // Unprocessed bytes, including a partial last line
+    bool firstLine = true;
+
+    auto processLine = [&](const char* line, std::size_t length) {
+        if (length > 0 && line[length - 1] == '\r') {
+            length--;
+        }
+        if (length == 0) {
+            return;
+        }
+        splitCSVLine(line, length, fields);
+        if (firstLine) {
+            firstLine = false;
+            if (equalsIgnoreCase(fields[0], "id") || equalsIgnoreCase(fields[0], "firstName")) {
+                return;             // Header row
+            }
+        }
+
+        std::size_t offset = fields.size() == 6 ? 1 : 0;      // Skip an exported id column
+        Employee emp;
+        if ((fields.size() != 5 && fields.size() != 6) || !parseEmployeeFields(&fields[offset], emp)) {
+            result.invalid++;
+            return;
+        }
+        stageImport(emp, result, seen, batch);
+    };
+
+    try {
+        // Read the file in large chunks and cut complete lines out of them
+        while (in.read(chunk.data(), static_cast<std::streamsize>(chunk.size())) || in.gcount() > 0) {
+            pending.append(chunk.data(), static_cast<std::size_t>(in.gcount()));
+            std::size_t start = 0;
+            while (true) {
+                std::size_t newline = pending.find('\n', start);
+                if (newline == std::string::npos) {
+                    break;
+                }
+                processLine(pending.data() + start, newline - start);
+                start = newline + 1;
+            }
+            pending.erase(0, start);
+        }
+        processLine(pending.data(), pending.size());    // Last line without a newline
+        appendBatch(batch);
+    }
+    catch (...) {
+        indexAppended(firstSlot);   // Batches appended before the failure stay
+        throw;
+    }
+    indexAppended(firstSlot);
+    return result;
+}
+
+// Loads raw Employee records (the data file layout). Deleted records are
+// skipped and new IDs are assigned.
+ImportResult EmployeeDB::importBinary(const std::string& path) {
+    ScopedTimer timer(metrics, Operation::Import);
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+
+    std::unique_lock<ReadWriteLock> guard(rwLock);     // One writer for the whole import
+    ImportResult result;
+    std::unordered_set<std::uint32_t> seen;     // SSNs added by this import
+    std::size_t firstSlot = store.size();
+    std::vector<Employee> incoming(BATCH_RECORDS);
+    std::vector<Employee> batch;
+    batch.reserve(BATCH_RECORDS);
+
+    try {
+        while (in.read(reinterpret_cast<char*>(incoming.data()), static_cast<std::streamsize>(incoming.size() * sizeof(Employee))) ||
+            in.gcount() > 0) {
+            std::size_t n = static_cast<std::size_t>(in.gcount()) / sizeof(Employee);
+            for (std::size_t i = 0; i < n; i++) {
+                Employee emp = incoming[i];
+                if (emp.isDeleted) {
+                    continue;
+                }
+                // Never trust terminators coming from outside
+                emp.firstName[20] = '\0';
+                emp.lastName[20] = '\0';
+                emp.ssn[11] = '\0';
+                if (!isValidSSN(emp.ssn) || !std::isfinite(emp.salary)) {
+                    result.invalid++;
+                    continue;
+                }
+                stageImport(emp, result, seen, batch);
+            }
+        }
+        appendBatch(batch);
+    }
+    catch (...) {
+        indexAppended(firstSlot);   // Batches appended before the failure stay
+        throw;
+    }
+    indexAppended(firstSlot);
+    return result;
+}
+
+// Loads a compact record file (see compact_record.h). Deleted records are
+// skipped and new IDs are assigned.
+ImportResult EmployeeDB::importCompact(const std::string& path) {
+    ScopedTimer timer(metrics, Operation::Import);
+    std::unique_lock<ReadWriteLock> guard(rwLock);
+    ImportResult result;
+    std::unordered_set<std::uint32_t> seen;     // SSNs added by this import
+    std::size_t firstSlot = store.size();
+    std::vector<Employee> batch;
+    batch.reserve(BATCH_RECORDS);
+
+    try {
+        readCompactFile(path, [&](const Employee& record) {
+            if (record.isDeleted) {
+                return;
+            }
+            if (!std::isfinite(record.salary)) {
+                result.invalid++;
+                return;
+            }
+            Employee emp = record;
+            stageImport(emp, result, seen, batch);
+        });
+        appendBatch(batch);
+    }
+    catch (...) {
+        indexAppended(firstSlot);   // Batches appended before the failure stay
+        throw;
+    }
+    indexAppended(firstSlot);
+    return result;
+}
+
+// Streams every live employee to a file in the given format; returns the
+// number of rows written
+std::size_t EmployeeDB::exportRows(const std::string& path, OutputFormat format) {
+    ScopedTimer timer(metrics, Operation::Export);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot create " + path);
+    }
+    std::shared_lock<ReadWriteLock> guard(rwLock);
+
+    RecordWriter writer(out, format);
+    std::size_t rows = 0;
+    for (const Employee& emp : store) {
+        if (!emp.isDeleted) {
+            writer.write(emp);
+            rows++;
+        }
+    }
+    try {
+        writer.flush();
+    }
+    catch (const std::runtime_error&) {
+        throw std::runtime_error("Error writing " + path);
+    }
+    return rows;
+}
+
+std::size_t EmployeeDB::exportCSV(const std::string& path) {
+    return exportRows(path, OutputFormat::CSV);
+}
+
+std::size_t EmployeeDB::exportBinary(const std::string& path) {
+    return exportRows(path, OutputFormat::Binary);
+}
+
+std::size_t EmployeeDB::exportJSONLines(const std::string& path) {
+    return exportRows(path, OutputFormat::JSONLines);
+}
+
+// Writes every live employee in the compact record format
+std::size_t EmployeeDB::exportCompact(const std::string& path) {
+    ScopedTimer timer(metrics, Operation::Export);
+    std::shared_lock<ReadWriteLock> guard(rwLock);
+    return writeCompactFile(path, store.data(), store.size(), true);
+}
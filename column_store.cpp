@@ -0,0 +1,250 @@
+#include "column_store.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define EMPLOYEEDB_X86 1
+#endif
+
+namespace {
+    // Scalar reference kernel; also handles the tail the SIMD loops leave over
+    template <typename T>
+    void compareScalar(const T* col, std::size_t begin, std::size_t n, CompareOp op, T value, std::uint64_t* out) {
+        for (std::size_t i = begin; i < n; i++) {
+            bool hit = false;
+            switch (op) {
+            case CompareOp::EQ: hit = col[i] == value; break;
+            case CompareOp::NE: hit = col[i] != value; break;
+            case CompareOp::LT: hit = col[i] < value; break;
+            case CompareOp::LE: hit = col[i] <= value; break;
+            case CompareOp::GT: hit = col[i] > value; break;
+            case CompareOp::GE: hit = col[i] >= value; break;
+            case CompareOp::PREFIX: break;          // Text only
+            }
+            if (hit) {
+                out[i / 64] |= std::uint64_t(1) << (i % 64);
+            }
+        }
+    }
+
+#ifdef EMPLOYEEDB_X86
+    bool cpuHasAvx2() {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+
+    // 8 floats per compare, 8 compares per 64-bit bitmap word
+    template <int Predicate>
+    __attribute__((target("avx2")))
+    std::size_t compareFloatAvx2(const float* col, std::size_t n, float value, std::uint64_t* out) {
+        const __m256 needle = _mm256_set1_ps(value);
+        std::size_t blocks = n / 64;
+        for (std::size_t b = 0; b < blocks; b++) {
+            const float* base = col + b * 64;
+            std::uint64_t word = 0;
+            for (int k = 0; k < 8; k++) {
+                __m256 hit = _mm256_cmp_ps(_mm256_loadu_ps(base + k * 8), needle, Predicate);
+                word |= static_cast<std::uint64_t>(_mm256_movemask_ps(hit)) << (k * 8);
+            }
+            out[b] = word;
+        }
+        return blocks * 64;
+    }
+
+    // Integer compares only come in EQ and GT flavours; the rest are derived
+    __attribute__((target("avx2")))
+    std::size_t compareIntAvx2(const int* col, std::size_t n, CompareOp op, int value, std::uint64_t* out) {
+        const __m256i needle = _mm256_set1_epi32(value);
+        std::size_t blocks = n / 64;
+        for (std::size_t b = 0; b < blocks; b++) {
+            const int* base = col + b * 64;
+            std::uint64_t word = 0;
+            for (int k = 0; k < 8; k++) {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + k * 8));
+                __m256i hit;
+                switch (op) {
+                case CompareOp::EQ: case CompareOp::NE: hit = _mm256_cmpeq_epi32(x, needle); break;
+                case CompareOp::GT: case CompareOp::LE: hit = _mm256_cmpgt_epi32(x, needle); break;
+                default:            hit = _mm256_cmpgt_epi32(needle, x); break;   // LT, GE
+                }
+                unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(hit)));
+                if (op == CompareOp::NE || op == CompareOp::LE || op == CompareOp::GE) {
+                    mask ^= 0xFFu;      // Negated predicates
+                }
+                word |= static_cast<std::uint64_t>(mask) << (k * 8);
+            }
+            out[b] = word;
+        }
+        return blocks * 64;
+    }
+
+    // 32 flag bytes per compare against zero
+    __attribute__((target("avx2")))
+    std::size_t liveRowsAvx2(const std::uint8_t* flags, std::size_t n, std::uint64_t* out) {
+        const __m256i zero = _mm256_setzero_si256();
+        std::size_t blocks = n / 64;
+        for (std::size_t b = 0; b < blocks; b++) {
+            const std::uint8_t* base = flags + b * 64;
+            __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base));
+            __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + 32));
+            std::uint64_t loMask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, zero)));
+            std::uint64_t hiMask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, zero)));
+            out[b] = loMask | (hiMask << 32);
+        }
+        return blocks * 64;
+    }
+#endif
+}
+
+// Copies the fields of every record the columns have not seen yet
+void ColumnStore::sync(const RecordStore& store) {
+    std::size_t start = size();
+    std::size_t total = store.size();
+    if (start >= total) {
+        return;
+    }
+
+    // Capacity at least doubles, so syncing after every small append (one
+    // insert between queries) stays amortized O(1) per record
+    auto grow = [total](auto& column) {
+        if (column.capacity() < total) {
+            column.reserve(std::max(total, 2 * column.capacity()));
+        }
+    };
+    grow(id);
+    grow(salary);
+    grow(age);
+    grow(isDeleted);
+    grow(firstName);
+    grow(lastName);
+    grow(ssn);
+    for (std::size_t slot = start; slot < total; slot++) {
+        const Employee& emp = store.at(slot);
+        id.push_back(emp.id);
+        salary.push_back(emp.salary);
+        age.push_back(emp.age);
+        isDeleted.push_back(emp.isDeleted ? 1 : 0);
+        firstName.emplace_back();
+        std::memcpy(firstName.back().data(), emp.firstName, sizeof(emp.firstName));
+        lastName.emplace_back();
+        std::memcpy(lastName.back().data(), emp.lastName, sizeof(emp.lastName));
+        ssn.emplace_back();
+        std::memcpy(ssn.back().data(), emp.ssn, sizeof(emp.ssn));
+    }
+}
+
+void ColumnStore::update(std::size_t slot, const Employee& emp) {
+    if (slot >= size()) {
+        return;             // Not loaded yet; the next sync picks it up
+    }
+    id[slot] = emp.id;
+    salary[slot] = emp.salary;
+    age[slot] = emp.age;
+    isDeleted[slot] = emp.isDeleted ? 1 : 0;
+    std::memcpy(firstName[slot].data(), emp.firstName, sizeof(emp.firstName));
+    std::memcpy(lastName[slot].data(), emp.lastName, sizeof(emp.lastName));
+    std::memcpy(ssn[slot].data(), emp.ssn, sizeof(emp.ssn));
+}
+
+void ColumnStore::clear() {
+    id.clear();
+    salary.clear();
+    age.clear();
+    isDeleted.clear();
+    firstName.clear();
+    lastName.clear();
+    ssn.clear();
+}
+
+void ColumnStore::filterSalary(CompareOp op, float value, SelectionBitmap& out) const {
+    filterSalary(op, value, 0, size(), out);
+}
+
+void ColumnStore::filterSalary(CompareOp op, float value, std::size_t begin, std::size_t end, SelectionBitmap& out) const {
+    const float* col = salary.data() + begin;
+    std::size_t n = end - begin;
+    out.assign((n + 63) / 64, 0);
+    std::size_t done = 0;
+#ifdef EMPLOYEEDB_X86
+    if (cpuHasAvx2()) {
+        switch (op) {
+        case CompareOp::EQ: done = compareFloatAvx2<_CMP_EQ_OQ>(col, n, value, out.data()); break;
+        case CompareOp::NE: done = compareFloatAvx2<_CMP_NEQ_UQ>(col, n, value, out.data()); break;
+        case CompareOp::LT: done = compareFloatAvx2<_CMP_LT_OQ>(col, n, value, out.data()); break;
+        case CompareOp::LE: done = compareFloatAvx2<_CMP_LE_OQ>(col, n, value, out.data()); break;
+        case CompareOp::GT: done = compareFloatAvx2<_CMP_GT_OQ>(col, n, value, out.data()); break;
+        case CompareOp::GE: done = compareFloatAvx2<_CMP_GE_OQ>(col, n, value, out.data()); break;
+        case CompareOp::PREFIX: break;
+        }
+    }
+#endif
+    compareScalar(col, done, n, op, value, out.data());
+}
+
+void ColumnStore::filterAge(CompareOp op, int value, SelectionBitmap& out) const {
+    filterInt(age.data(), size(), op, value, out);
+}
+
+void ColumnStore::filterAge(CompareOp op, int value, std::size_t begin, std::size_t end, SelectionBitmap& out) const {
+    filterInt(age.data() + begin, end - begin, op, value, out);
+}
+
+void ColumnStore::filterId(CompareOp op, int value, SelectionBitmap& out) const {
+    filterInt(id.data(), size(), op, value, out);
+}
+
+void ColumnStore::filterId(CompareOp op, int value, std::size_t begin, std::size_t end, SelectionBitmap& out) const {
+    filterInt(id.data() + begin, end - begin, op, value, out);
+}
+
+void ColumnStore::filterInt(const int* col, std::size_t n, CompareOp op, int value, SelectionBitmap& out) {
+    out.assign((n + 63) / 64, 0);
+    std::size_t done = 0;
+#ifdef EMPLOYEEDB_X86
+    if (cpuHasAvx2()) {
+        done = compareIntAvx2(col, n, op, value, out.data());
+    }
+#endif
+    compareScalar(col, done, n, op, value, out.data());
+}
+
+void ColumnStore::liveRows(SelectionBitmap& out) const {
+    liveRows(0, size(), out);
+}
+
+void ColumnStore::liveRows(std::size_t begin, std::size_t end, SelectionBitmap& out) const {
+    const std::uint8_t* flags = isDeleted.data() + begin;
+    std::size_t n = end - begin;
+    out.assign((n + 63) / 64, 0);
+    std::size_t done = 0;
+#ifdef EMPLOYEEDB_X86
+    if (cpuHasAvx2()) {
+        done = liveRowsAvx2(flags, n, out.data());
+    }
+#endif
+    for (std::size_t i = done; i < n; i++) {
+        if (!flags[i]) {
+            out[i / 64] |= std::uint64_t(1) << (i % 64);
+        }
+    }
+}
+
+void intersectBitmaps(SelectionBitmap& out, const SelectionBitmap& other) {
+    std::size_t n = out.size() < other.size() ? out.size() : other.size();
+    for (std::size_t i = 0; i < n; i++) {
+        out[i] &= other[i];
+    }
+    for (std::size_t i = n; i < out.size(); i++) {
+        out[i] = 0;
+    }
+}
+
+void unionBitmaps(SelectionBitmap& out, const SelectionBitmap& other) {
+    if (out.size() < other.size()) {
+        out.resize(other.size(), 0);
+    }
+    for (std::size_t i = 0; i < other.size(); i++) {
+        out[i] |= other[i];
+    }
+}
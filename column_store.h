@@ -0,0 +1,78 @@
+#ifndef COLUMN_STORE_H
+#define COLUMN_STORE_H
+
+#include "record_store.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+// One bit per record slot; bit (slot % 64) of word (slot / 64). Query
+// scans allocate their bitmaps from the query's arena (query_arena.h).
+using SelectionBitmap = std::pmr::vector<std::uint64_t>;
+
+// Comparison operators understood by the filter kernels.
+// PREFIX (starts with) applies to text fields only.
+enum class CompareOp { EQ, NE, LT, LE, GT, GE, PREFIX };
+
+// Structure-of-arrays copy of the record file for analytic scans.
+// Each field lives in its own contiguous column so predicates on one
+// field only touch that field's bytes and can be evaluated with SIMD.
+class ColumnStore {
+public:
+    // Appends any records the store has that the columns do not yet hold
+    void sync(const RecordStore& store);
+    // Reflects an in-place update (e.g. a soft delete) of an existing slot
+    void update(std::size_t slot, const Employee& emp);
+    void clear();
+
+    std::size_t size() const { return id.size(); }
+
+    // Predicate kernels: write one bit per slot into out (resized to fit)
+    void filterSalary(CompareOp op, float value, SelectionBitmap& out) const;
+    void filterAge(CompareOp op, int value, SelectionBitmap& out) const;
+    void filterId(CompareOp op, int value, SelectionBitmap& out) const;
+    void liveRows(SelectionBitmap& out) const;     // Bits set for non-deleted slots
+
+    // Same kernels over slots [begin, end) only, so chunks can be scanned in
+    // parallel. Bit k of out stands for slot begin + k; begin must be a
+    // multiple of 64.
+    void filterSalary(CompareOp op, float value, std::size_t begin, std::size_t end, SelectionBitmap& out) const;
+    void filterAge(CompareOp op, int value, std::size_t begin, std::size_t end, SelectionBitmap& out) const;
+    void filterId(CompareOp op, int value, std::size_t begin, std::size_t end, SelectionBitmap& out) const;
+    void liveRows(std::size_t begin, std::size_t end, SelectionBitmap& out) const;
+
+    // Columns
+    std::vector<int> id;
+    std::vector<float> salary;
+    std::vector<int> age;
+    std::vector<std::uint8_t> isDeleted;
+    std::vector<std::array<char, 21>> firstName;
+    std::vector<std::array<char, 21>> lastName;
+    std::vector<std::array<char, 12>> ssn;
+
+private:
+    static void filterInt(const int* col, std::size_t n, CompareOp op, int value, SelectionBitmap& out);
+};
+
+// out[i] &= other[i]
+void intersectBitmaps(SelectionBitmap& out, const SelectionBitmap& other);
+
+// out[i] |= other[i]
+void unionBitmaps(SelectionBitmap& out, const SelectionBitmap& other);
+
+// Calls visit(slot) for every set bit, in slot order; base is the slot of bit 0
+template <typename Visit>
+void forEachSelected(const SelectionBitmap& bits, Visit visit, std::size_t base = 0) {
+    for (std::size_t w = 0; w < bits.size(); w++) {
+        std::uint64_t word = bits[w];
+        while (word) {
+            int bit = __builtin_ctzll(word);       // Lowest set bit
+            visit(base + w * 64 + static_cast<std::size_t>(bit));
+            word &= word - 1;                      // Clear it
+        }
+    }
+}
+
+#endif
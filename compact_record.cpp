@@ -0,0 +1,159 @@
+#include "compact_record.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+    const char COMPACT_MAGIC[8] = { 'E', 'M', 'P', 'C', 'M', 'P', '0', '1' };
+    const std::uint32_t DELETED_FLAG = 1u << 31;
+    const std::uint32_t SSN_MASK = (1u << 30) - 1;
+    const std::size_t BATCH_RECORDS = 8192;
+
+    struct CompactHeader {
+        char magic[8];
+        std::uint64_t recordCount;
+        std::uint64_t heapBytes;        // Name heap length, stored after the records
+    };
+}
+
+std::uint32_t NameDictionary::intern(const char* name, std::size_t length) {
+    std::string key(name, length);
+    auto found = codes.find(key);
+    if (found != codes.end()) {
+        return found->second;
+    }
+    std::uint32_t code = static_cast<std::uint32_t>(offsets.size());
+    offsets.push_back(static_cast<std::uint32_t>(heap.size()));
+    heap.insert(heap.end(), name, name + length);
+    heap.push_back('\0');
+    codes.emplace(std::move(key), code);
+    return code;
+}
+
+void NameDictionary::assign(const char* bytes, std::size_t length) {
+    heap.clear();
+    offsets.clear();
+    codes.clear();
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < length; i++) {
+        if (bytes[i] == '\0') {
+            intern(bytes + start, i - start);
+            start = i + 1;
+        }
+    }
+}
+
+CompactEmployee compactEmployee(const Employee& emp, NameDictionary& names) {
+    char ssn[12];
+    std::memcpy(ssn, emp.ssn, 11);
+    ssn[11] = '\0';
+    if (!isValidSSN(ssn)) {
+        throw std::invalid_argument("Cannot compact a record with SSN '" + std::string(ssn) + "'");
+    }
+    CompactEmployee rec;
+    rec.id = emp.id;
+    rec.ssnAndFlags = packSSN(ssn) | (emp.isDeleted ? DELETED_FLAG : 0);
+    rec.salary = emp.salary;
+    rec.age = emp.age;
+    rec.firstName = names.intern(emp.firstName, strnlen(emp.firstName, 20));
+    rec.lastName = names.intern(emp.lastName, strnlen(emp.lastName, 20));
+    return rec;
+}
+
+Employee expandEmployee(const CompactEmployee& rec, const NameDictionary& names) {
+    std::uint32_t ssn = rec.ssnAndFlags & SSN_MASK;
+    if (rec.firstName >= names.size() || rec.lastName >= names.size() || ssn > 999999999) {
+        throw std::invalid_argument("Compact record " + std::to_string(rec.id) + " is malformed");
+    }
+    Employee emp;
+    std::memset(&emp, 0, sizeof(Employee));
+    emp.id = rec.id;
+    std::strncpy(emp.firstName, names.name(rec.firstName), 20);
+    std::strncpy(emp.lastName, names.name(rec.lastName), 20);
+    std::snprintf(emp.ssn, sizeof(emp.ssn), "%03u-%02u-%04u", ssn / 1000000 % 1000, ssn / 10000 % 100, ssn % 10000);
+    emp.salary = rec.salary;
+    emp.age = rec.age;
+    emp.isDeleted = (rec.ssnAndFlags & DELETED_FLAG) != 0;
+    return emp;
+}
+
+// Records are streamed out in batches while names are interned; the header,
+// whose counts are only known at the end, is written last
+std::size_t writeCompactFile(const std::string& path, const Employee* records, std::size_t count, bool liveOnly) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot create " + path);
+    }
+    CompactHeader header;
+    std::memcpy(header.magic, COMPACT_MAGIC, sizeof(COMPACT_MAGIC));
+    header.recordCount = 0;
+    header.heapBytes = 0;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    NameDictionary names;
+    std::vector<CompactEmployee> batch;
+    batch.reserve(BATCH_RECORDS);
+    auto flush = [&]() {
+        out.write(reinterpret_cast<const char*>(batch.data()), static_cast<std::streamsize>(batch.size() * sizeof(CompactEmployee)));
+        header.recordCount += batch.size();
+        batch.clear();
+    };
+    for (std::size_t i = 0; i < count; i++) {
+        if (liveOnly && records[i].isDeleted) {
+            continue;
+        }
+        batch.push_back(compactEmployee(records[i], names));
+        if (batch.size() == BATCH_RECORDS) {
+            flush();
+        }
+    }
+    flush();
+
+    const std::vector<char>& heap = names.bytes();
+    out.write(heap.data(), static_cast<std::streamsize>(heap.size()));
+    header.heapBytes = heap.size();
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!out) {
+        throw std::runtime_error("Error writing " + path);
+    }
+    return static_cast<std::size_t>(header.recordCount);
+}
+
+std::size_t readCompactFile(const std::string& path, const std::function<void(const Employee&)>& visit) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    CompactHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, COMPACT_MAGIC, sizeof(COMPACT_MAGIC)) != 0) {
+        throw std::runtime_error(path + " is not a compact employee file");
+    }
+
+    // The dictionary sits after the records, so load it first
+    std::vector<char> heap(static_cast<std::size_t>(header.heapBytes));
+    in.seekg(static_cast<std::streamoff>(sizeof(header) + header.recordCount * sizeof(CompactEmployee)));
+    if (!in.read(heap.data(), static_cast<std::streamsize>(heap.size()))) {
+        throw std::runtime_error(path + " is truncated");
+    }
+    NameDictionary names;
+    names.assign(heap.data(), heap.size());
+
+    in.seekg(sizeof(header));
+    std::vector<CompactEmployee> batch(BATCH_RECORDS);
+    std::uint64_t remaining = header.recordCount;
+    while (remaining > 0) {
+        std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(remaining, BATCH_RECORDS));
+        if (!in.read(reinterpret_cast<char*>(batch.data()), static_cast<std::streamsize>(n * sizeof(CompactEmployee)))) {
+            throw std::runtime_error(path + " is truncated");
+        }
+        for (std::size_t i = 0; i < n; i++) {
+            visit(expandEmployee(batch[i], names));
+        }
+        remaining -= n;
+    }
+    return static_cast<std::size_t>(header.recordCount);
+}
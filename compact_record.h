@@ -0,0 +1,58 @@
+#ifndef COMPACT_RECORD_H
+#define COMPACT_RECORD_H
+
+#include "record.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Compact form of an Employee record: 24 bytes instead of the 72 of the
+// raw struct. The SSN is packed into 30 bits next to the deleted flag and
+// both names are codes into a NameDictionary stored once per file, so
+// repeated names cost 4 bytes per record.
+struct CompactEmployee {
+    std::int32_t id;
+    std::uint32_t ssnAndFlags;       // Bits 0-29: packed SSN; bit 31: deleted
+    float salary;
+    std::int32_t age;
+    std::uint32_t firstName;         // NameDictionary codes
+    std::uint32_t lastName;
+};
+
+static_assert(sizeof(CompactEmployee) == 24, "CompactEmployee must stay packed");
+
+// Interned name strings. Codes are dense and handed out in first-seen
+// order; the strings live back to back, NUL terminated, in one heap.
+class NameDictionary {
+public:
+    std::uint32_t intern(const char* name, std::size_t length);
+    const char* name(std::uint32_t code) const { return heap.data() + offsets[code]; }
+    std::size_t size() const { return offsets.size(); }
+
+    // Raw heap bytes, and rebuilding a dictionary from them
+    const std::vector<char>& bytes() const { return heap; }
+    void assign(const char* bytes, std::size_t length);
+
+private:
+    std::vector<char> heap;
+    std::vector<std::uint32_t> offsets;                  // code -> heap offset
+    std::unordered_map<std::string, std::uint32_t> codes;
+};
+
+// Converters between the raw and compact layouts. Compacting throws
+// std::invalid_argument for a malformed SSN; expanding throws for a name
+// code the dictionary does not have or an out-of-range SSN.
+CompactEmployee compactEmployee(const Employee& emp, NameDictionary& names);
+Employee expandEmployee(const CompactEmployee& rec, const NameDictionary& names);
+
+// Compact file: a header, the records, then the name heap. Writing skips
+// deleted records when liveOnly is set and returns the number written;
+// reading expands every record in file order. Both throw
+// std::runtime_error on I/O errors or a malformed file.
+std::size_t writeCompactFile(const std::string& path, const Employee* records, std::size_t count, bool liveOnly);
+std::size_t readCompactFile(const std::string& path, const std::function<void(const Employee&)>& visit);
+
+#endif
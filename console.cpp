@@ -0,0 +1,579 @@
+#include "console.h"
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+
+namespace {
+    const char* RECORD_SEPARATOR = "------------------------\n";
+    const std::size_t SCRIPT_QUEUE_COMMANDS = 1 << 16;     // Commands queued before a script runs them
+
+    // Splits a script line into words; "double quotes" keep spaces in a word
+    std::vector<std::string> splitWords(const std::string& line) {
+        std::vector<std::string> words;
+        std::size_t i = 0;
+        while (i < line.size()) {
+            if (std::isspace(static_cast<unsigned char>(line[i]))) {
+                i++;
+                continue;
+            }
+            std::string word;
+            if (line[i] == '"') {
+                std::size_t close = line.find('"', i + 1);
+                if (close == std::string::npos) {
+                    throw std::invalid_argument("Unterminated quote");
+                }
+                word = line.substr(i + 1, close - i - 1);
+                i = close + 1;
+            }
+            else {
+                while (i < line.size() && !std::isspace(static_cast<unsigned char>(line[i]))) {
+                    word += line[i++];
+                }
+            }
+            words.push_back(word);
+        }
+        return words;
+    }
+
+    // Parses a whole-word integer; what names the value in the error
+    int parseInt(const std::string& text, const char* what) {
+        char* end = nullptr;
+        long value = std::strtol(text.c_str(), &end, 10);
+        if (text.empty() || *end != '\0' || value < INT_MIN || value > INT_MAX) {
+            throw std::invalid_argument(std::string("Invalid ") + what + " '" + text + "'");
+        }
+        return static_cast<int>(value);
+    }
+
+    // Prints an aggregate result as a header line and one comma separated
+    // line per group; sums and averages get two decimals
+    void printAggregates(const AggregateTable& table) {
+        for (std::size_t i = 0; i < table.columns.size(); i++) {
+            std::cout << (i > 0 ? ", " : "") << table.columns[i];
+        }
+        std::cout << "\n";
+        if (table.rows.empty()) {
+            std::cout << "No matching records found.\n";
+            return;
+        }
+        for (const std::vector<AggregateValue>& row : table.rows) {
+            for (std::size_t i = 0; i < row.size(); i++) {
+                if (i > 0) {
+                    std::cout << ", ";
+                }
+                const AggregateValue& value = row[i];
+                switch (value.type) {
+                case AggregateValue::Type::Null: std::cout << "NULL"; break;
+                case AggregateValue::Type::Int: std::cout << value.intValue; break;
+                case AggregateValue::Type::Float: {
+                    std::streamsize precision = std::cout.precision();
+                    std::cout << std::fixed << std::setprecision(2) << value.floatValue;
+                    std::cout << std::defaultfloat << std::setprecision(precision);
+                    break;
+                }
+                case AggregateValue::Type::Text: std::cout << value.text; break;
+                }
+            }
+            std::cout << "\n";
+        }
+    }
+
+    // Case-insensitive check for an extension such as ".csv"
+    bool hasExtension(const std::string& path, const std::string& wanted) {
+        if (path.size() < wanted.size()) {
+            return false;
+        }
+        std::string ext = path.substr(path.size() - wanted.size());
+        for (char& c : ext) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return ext == wanted;
+    }
+}
+
+// Prompts for a new employee and adds it
+void Console::addEmployee() {
+    Employee emp{};
+
+    // Get employee details with input validation
+    std::cout << "Enter First Name (max 20 chars): ";
+    std::cin.getline(emp.firstName, 21);
+    std::cout << "Enter Last Name (max 20 chars): ";   // 20 chars + null terminator
+    std::cin.getline(emp.lastName, 21);
+
+    // Validate SSN format
+    bool validSSN = false;
+    while (!validSSN) {
+        std::cout << "Enter SSN (format XXX-XX-XXXX): ";
+        std::cin.getline(emp.ssn, 12);
+        validSSN = isValidSSN(emp.ssn);
+
+        if (!validSSN) {
+            std::cout << "Invalid SSN format. Please try again.\n";
+        }
+        else if (db.findBySSN(emp.ssn)) {
+            std::cout << "SSN already exists in database.\n";
+            validSSN = false;
+        }
+    }
+
+    std::cout << "Enter Salary: ";
+    std::cin >> emp.salary;
+    std::cout << "Enter Age: ";
+    std::cin >> emp.age;
+    std::cin.ignore();        // Clear leftover newline character
+
+    int id = db.insert(emp);
+    std::cout << "Employee added successfully. ID: " << id << "\n";
+}
+
+// Displays employees with optional sorting
+void Console::displayEmployees(bool indexed, int field) {
+    if (db.recordCount() == 0) {
+        std::cout << "No employee data found.\n";
+        return;
+    }
+
+    QueryResult employees = indexed ? db.sortedBy(field, true) : db.employees();
+    if (employees.empty()) {
+        std::cout << "No employees to display.\n";
+        return;
+    }
+
+    // Display all employee records
+    RecordWriter writer(std::cout, outputFormat);
+    writer.setSeparator(RECORD_SEPARATOR);
+    for (const Employee& emp : employees) {
+        writer.write(emp);
+    }
+    writer.flush();
+}
+
+// Deletes an employee by ID
+void Console::deleteEmployee() {
+    int idToDelete;
+    std::cout << "Enter Employee ID to delete: ";
+    std::cin >> idToDelete;
+    std::cin.ignore();
+
+    if (db.erase(idToDelete)) {
+        std::cout << "Employee deleted successfully.\n";
+    }
+    else {
+        std::cout << "Employee not found or already deleted.\n";
+    }
+}
+
+// Displays a single employee looked up by ID
+void Console::displayEmployeeById() {
+    int id;
+    std::cout << "Enter Employee ID to display: ";
+    std::cin >> id;
+    std::cin.ignore();
+
+    std::optional<Employee> emp = db.findById(id);
+    if (!emp) {
+        std::cout << "Employee not found.\n";
+        return;
+    }
+    RecordWriter writer(std::cout, outputFormat);
+    writer.write(*emp);
+    writer.flush();
+}
+
+// Lists employees ordered by the chosen field
+void Console::indexByField(int field, bool ascending) {
+    if (db.recordCount() == 0) {
+        std::cout << "No employee data found.\n";
+        return;
+    }
+
+    QueryResult sorted = db.sortedBy(field, ascending);
+    if (sorted.empty()) {
+        std::cout << "No employees to index.\n";
+        return;
+    }
+
+    static const Field fields[] = { Field::Salary, Field::Age, Field::LastName, Field::SSN };
+    if (outputFormat != OutputFormat::Text) {
+        // Machine-readable formats get the ID and the sorted field per row
+        RecordWriter writer(std::cout, outputFormat, { Field::Id, fields[field - 1] });
+        for (const Employee& emp : sorted) {
+            writer.write(emp);
+        }
+        writer.flush();
+        return;
+    }
+
+    // Display sorted results
+    RecordWriter writer(std::cout, outputFormat);
+    writer.text("Employees indexed by field ").number(static_cast<long long>(field))
+        .text(ascending ? " (ascending):\n" : " (descending):\n");
+    for (const Employee& emp : sorted) {
+        // Display the requested field
+        writer.text("ID: ").number(static_cast<long long>(emp.id)).text(" - ");
+        switch (field) {
+        case 1: writer.text("Salary: $").number(emp.salary); break;
+        case 2: writer.text("Age: ").number(static_cast<long long>(emp.age)); break;
+        case 3: writer.text("Last Name: ").text(emp.lastName); break;
+        case 4: writer.text("SSN: ").text(emp.ssn); break;
+        }
+        writer.text("\n");
+    }
+    writer.flush();
+}
+
+// Searches for an employee by SSN
+void Console::searchBySSN() {
+    char searchSSN[12];               // Buffer to store SSN input (11 chars + null terminator)
+    std::cout << "Enter SSN to search (XXX-XX-XXXX): ";
+    std::cin.getline(searchSSN, 12);        // Get SSN from user
+
+    std::optional<Employee> emp = db.findBySSN(searchSSN);
+    if (emp) {
+        RecordWriter writer(std::cout, outputFormat);
+        if (outputFormat == OutputFormat::Text) {
+            writer.text("Employee found:\n");
+        }
+        writer.write(*emp);
+        writer.flush();
+    }
+    else {
+        std::cout << "Employee with SSN " << searchSSN << " not found.\n";
+    }
+}
+
+// Runs a SQL-like query and prints the matching rows
+void Console::runQuery(const std::string& query) {
+    QueryResult result;
+    try {
+        result = db.query(query);
+    }
+    catch (const std::invalid_argument& e) {
+        std::cout << "Invalid query format: " << e.what() << "\n";
+        return;
+    }
+    printQueryResult(result);
+}
+
+// Prints query rows (or aggregate groups) in the console's output format
+void Console::printQueryResult(const QueryResult& result) {
+    if (result.isAggregate()) {
+        printAggregates(result.aggregates());
+        return;
+    }
+    // Other formats print an empty result as no rows (a CSV header alone)
+    if (outputFormat == OutputFormat::Text && db.recordCount() == 0) {
+        std::cout << "No employee data found.\n";
+        return;
+    }
+    if (outputFormat == OutputFormat::Text && result.empty()) {
+        std::cout << "No matching records found.\n";
+        return;
+    }
+
+    // SELECT * prints full record blocks, a field list only those fields
+    RecordWriter writer(std::cout, outputFormat, result.projection());
+    writer.setSeparator(RECORD_SEPARATOR);
+    for (const Employee& emp : result) {
+        writer.write(emp);
+    }
+    writer.flush();
+}
+
+// Manually triggered compaction (vacuum)
+void Console::compact() {
+    std::size_t removed = db.compact();
+    std::cout << "Compaction removed " << removed << " deleted record(s).\n";
+}
+
+void Console::showStats(bool json) {
+    MetricsSnapshot stats = db.stats();
+    if (json) {
+        writeStatsJSON(stats, std::cout);
+    }
+    else {
+        writeStatsText(stats, std::cout);
+    }
+}
+
+// Prompts for a file and imports it (CSV by extension, raw records otherwise)
+void Console::importEmployees() {
+    std::string path;
+    std::cout << "Enter file to import (.csv, .ecr compact, or binary): ";
+    std::getline(std::cin, path);
+
+    ImportResult result = hasExtension(path, ".csv") ? db.importCSV(path) :
+        hasExtension(path, ".ecr") ? db.importCompact(path) : db.importBinary(path);
+    std::cout << "Imported " << result.imported << " employee(s); skipped "
+        << result.invalid << " invalid row(s) and " << result.duplicates << " duplicate SSN(s).\n";
+}
+
+// Prompts for a file and exports all active employees to it
+void Console::exportEmployees() {
+    std::string path;
+    std::cout << "Enter file to export to (.csv, .jsonl, .ecr compact, or binary): ";
+    std::getline(std::cin, path);
+
+    std::size_t rows = hasExtension(path, ".csv") ? db.exportCSV(path) :
+        hasExtension(path, ".jsonl") ? db.exportJSONLines(path) :
+        hasExtension(path, ".ecr") ? db.exportCompact(path) : db.exportBinary(path);
+    std::cout << "Exported " << rows << " employee(s) to " << path << ".\n";
+}
+
+// Reads the whole script, executing the queued commands whenever enough
+// have piled up and once more at the end
+std::size_t Console::runScript(std::istream& script) {
+    std::size_t failures = 0;
+    std::size_t number = 0;
+    std::string line;
+    while (std::getline(script, line)) {
+        number++;
+        Command command;
+        command.line = number;
+        try {
+            if (!parseCommand(line, command)) {
+                continue;           // Blank line or comment
+            }
+        }
+        catch (const std::invalid_argument& e) {
+            std::cerr << "Error: line " << number << ": " << e.what() << "\n";
+            failures++;
+            continue;
+        }
+        commandQueue.push(std::move(command));
+        if (commandQueue.size() >= SCRIPT_QUEUE_COMMANDS) {
+            failures += processCommandQueue();
+        }
+    }
+    failures += processCommandQueue();
+    return failures;
+}
+
+// Parses one script line; false for blank lines and comments. Malformed
+// commands throw std::invalid_argument.
+bool Console::parseCommand(const std::string& line, Command& command) {
+    std::size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string::npos || line[start] == '#') {
+        return false;
+    }
+    std::size_t verbEnd = line.find_first_of(" \t\r", start);
+    std::string verb = line.substr(start, verbEnd == std::string::npos ? std::string::npos : verbEnd - start);
+    for (char& c : verb) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    if (verb == "query") {
+        // The statement is the rest of the line, verbatim
+        std::size_t text = verbEnd == std::string::npos ? std::string::npos : line.find_first_not_of(" \t", verbEnd);
+        if (text == std::string::npos) {
+            throw std::invalid_argument("query needs a statement");
+        }
+        command.kind = Command::Kind::Query;
+        command.text = line.substr(text);
+        while (!command.text.empty() && command.text.back() == '\r') {
+            command.text.pop_back();
+        }
+        return true;
+    }
+
+    std::vector<std::string> words = splitWords(line.substr(start));
+    auto expect = [&](std::size_t arguments, const char* usage) {
+        if (words.size() != arguments + 1) {
+            throw std::invalid_argument(std::string("Usage: ") + usage);
+        }
+    };
+    if (verb == "add") {
+        expect(5, "add firstName lastName ssn salary age");
+        if (words[1].size() > 20 || words[2].size() > 20) {
+            throw std::invalid_argument("Names are limited to 20 characters");
+        }
+        if (words[3].size() != 11) {
+            throw std::invalid_argument("Invalid SSN format");
+        }
+        Employee& emp = command.emp;
+        std::memcpy(emp.firstName, words[1].data(), words[1].size());
+        std::memcpy(emp.lastName, words[2].data(), words[2].size());
+        std::memcpy(emp.ssn, words[3].data(), words[3].size());
+        char* end = nullptr;
+        errno = 0;
+        emp.salary = std::strtof(words[4].c_str(), &end);
+        if (*end != '\0' || errno == ERANGE || !std::isfinite(emp.salary)) {
+            throw std::invalid_argument("Invalid salary '" + words[4] + "'");
+        }
+        emp.age = parseInt(words[5], "age");
+        command.kind = Command::Kind::Add;
+    }
+    else if (verb == "delete") {
+        expect(1, "delete id");
+        command.kind = Command::Kind::Delete;
+        command.id = parseInt(words[1], "ID");
+    }
+    else if (verb == "search") {
+        expect(1, "search ssn");
+        command.kind = Command::Kind::Search;
+        command.text = words[1];
+    }
+    else if (verb == "show") {
+        expect(1, "show id");
+        command.kind = Command::Kind::Show;
+        command.id = parseInt(words[1], "ID");
+    }
+    else if (verb == "stats") {
+        if (words.size() > 2 || (words.size() == 2 && words[1] != "json")) {
+            throw std::invalid_argument("Usage: stats [json]");
+        }
+        command.kind = Command::Kind::Stats;
+        command.text = words.size() == 2 ? words[1] : "";
+    }
+    else {
+        throw std::invalid_argument("Unknown command '" + verb + "'");
+    }
+    return true;
+}
+
+bool Console::isMutation(const Command& command) {
+    return command.kind == Command::Kind::Add || command.kind == Command::Kind::Delete;
+}
+
+// Drains the command queue in groups: consecutive adds and deletes go to the
+// engine as one write batch (one lock, one log sync), consecutive searches,
+// shows and queries run as one read group whose queries share a single scan.
+// A stats command ends the group before it, so it reports on everything above
+// it. Returns the number of failed commands.
+std::size_t Console::processCommandQueue() {
+    std::size_t failures = 0;
+    while (!commandQueue.empty()) {
+        if (commandQueue.front().kind == Command::Kind::Stats) {
+            showStats(commandQueue.front().text == "json");
+            commandQueue.pop();
+            continue;
+        }
+        bool writes = isMutation(commandQueue.front());
+        std::vector<Command> group;
+        while (!commandQueue.empty() && commandQueue.front().kind != Command::Kind::Stats &&
+            isMutation(commandQueue.front()) == writes) {
+            group.push_back(std::move(commandQueue.front()));
+            commandQueue.pop();
+        }
+        failures += writes ? runWriteGroup(group) : runReadGroup(group);
+    }
+    return failures;
+}
+
+std::size_t Console::runWriteGroup(const std::vector<Command>& group) {
+    std::vector<Mutation> mutations(group.size());
+    for (std::size_t i = 0; i < group.size(); i++) {
+        if (group[i].kind == Command::Kind::Add) {
+            mutations[i].kind = Mutation::Kind::Insert;
+            mutations[i].emp = group[i].emp;
+        }
+        else {
+            mutations[i].kind = Mutation::Kind::Erase;
+            mutations[i].id = group[i].id;
+        }
+    }
+    std::vector<MutationResult> results = db.applyBatch(mutations);
+
+    // Only text output reports successful writes; the other formats carry
+    // rows alone, so they get no writer (and no CSV header)
+    std::size_t failures = 0;
+    std::optional<RecordWriter> writer;
+    if (outputFormat == OutputFormat::Text) {
+        writer.emplace(std::cout, outputFormat);
+    }
+    for (std::size_t i = 0; i < results.size(); i++) {
+        if (!results[i].ok) {
+            std::cerr << "Error: line " << group[i].line << ": " << results[i].error << "\n";
+            failures++;
+        }
+        else if (writer) {
+            if (mutations[i].kind == Mutation::Kind::Insert) {
+                writer->text("Employee added successfully. ID: ").number(static_cast<long long>(results[i].id)).text("\n");
+            }
+            else {
+                writer->text("Employee deleted successfully.\n");
+            }
+        }
+    }
+    if (writer) {
+        writer->flush();
+    }
+    return failures;
+}
+
+std::size_t Console::runReadGroup(const std::vector<Command>& group) {
+    // Compile every query first so they can run as one batch
+    std::vector<QueryPlan> plans;
+    std::vector<std::string> errors(group.size());
+    for (std::size_t i = 0; i < group.size(); i++) {
+        if (group[i].kind == Command::Kind::Query) {
+            try {
+                plans.push_back(db.planQuery(group[i].text));
+            }
+            catch (const std::invalid_argument& e) {
+                errors[i] = e.what();
+            }
+        }
+    }
+    std::vector<QueryResult> results = db.queryBatch(plans);
+
+    std::size_t failures = 0;
+    std::size_t next = 0;           // Next query result
+    // Search and show rows share a writer, created on first use so that a
+    // group of queries alone prints no extra CSV header. A query ends it:
+    // rows after the query's own output start under a fresh header.
+    std::optional<RecordWriter> writer;
+    auto rowWriter = [&]() -> RecordWriter& {
+        if (!writer) {
+            writer.emplace(std::cout, outputFormat);
+            writer->setSeparator(RECORD_SEPARATOR);
+        }
+        return *writer;
+    };
+    for (std::size_t i = 0; i < group.size(); i++) {
+        const Command& command = group[i];
+        if (!errors[i].empty()) {
+            std::cerr << "Error: line " << command.line << ": Invalid query format: " << errors[i] << "\n";
+            failures++;
+            continue;
+        }
+        std::optional<Employee> emp;
+        switch (command.kind) {
+        case Command::Kind::Search:
+            emp = db.findBySSN(command.text);
+            if (!emp && outputFormat == OutputFormat::Text) {
+                rowWriter().text("Employee with SSN ").text(command.text).text(" not found.\n");
+            }
+            break;
+        case Command::Kind::Show:
+            emp = db.findById(command.id);
+            if (!emp && outputFormat == OutputFormat::Text) {
+                rowWriter().text("Employee not found.\n");
+            }
+            break;
+        default:
+            // Query output has its own projection, so it gets its own writer
+            if (writer) {
+                writer->flush();
+                writer.reset();
+            }
+            printQueryResult(results[next++]);
+            break;
+        }
+        if (emp) {
+            rowWriter().write(*emp);
+        }
+    }
+    if (writer) {
+        writer->flush();
+    }
+    return failures;
+}
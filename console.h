@@ -0,0 +1,69 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include "employee.h"
+#include <cstddef>
+#include <istream>
+#include <queue>
+#include <string>
+#include <vector>
+
+// Interactive front end for the menu in main.cpp. Prompts on std::cin,
+// prints to std::cout and does all real work through the EmployeeDB API.
+class Console {
+public:
+    explicit Console(EmployeeDB& db) : db(db) {}
+
+    // Format of the rows printed by display, search, index and query
+    void setOutputFormat(OutputFormat format) { outputFormat = format; }
+
+    void addEmployee();
+    void displayEmployees(bool indexed = false, int field = 0);
+    void deleteEmployee();
+    void displayEmployeeById();
+    void indexByField(int field, bool ascending);
+    void searchBySSN();
+    void runQuery(const std::string& query);
+    void compact();
+    void importEmployees();
+    void exportEmployees();
+    // Latency percentiles per operation, event counts and file I/O so far;
+    // json prints the same as one JSON object
+    void showStats(bool json = false);
+
+    // Batch mode: runs a script of commands, one per line, without prompts:
+    //   add firstName lastName ssn salary age
+    //   delete id
+    //   search ssn
+    //   show id
+    //   query SELECT ...
+    //   stats [json]
+    // Blank lines and lines starting with # are skipped; "double quotes"
+    // allow spaces in names. Returns the number of commands that failed
+    // (errors go to std::cerr).
+    std::size_t runScript(std::istream& script);
+
+private:
+    // One parsed script line
+    struct Command {
+        enum class Kind { Add, Delete, Search, Show, Query, Stats };
+        Kind kind = Kind::Add;
+        Employee emp{};                // Add
+        int id = 0;                    // Delete, Show
+        std::string text;              // Search (SSN), Query (statement), Stats ("json" or empty)
+        std::size_t line = 0;          // Script line, for error messages
+    };
+
+    EmployeeDB& db;
+    std::queue<Command> commandQueue;  // Parsed commands not yet executed
+    OutputFormat outputFormat = OutputFormat::Text;
+
+    static bool parseCommand(const std::string& line, Command& command);
+    static bool isMutation(const Command& command);
+    void printQueryResult(const QueryResult& result);
+    std::size_t processCommandQueue();
+    std::size_t runWriteGroup(const std::vector<Command>& group);
+    std::size_t runReadGroup(const std::vector<Command>& group);
+};
+
+#endif
@@ -1,522 +1,935 @@
 #include "employee.h"
-#include <queue>
-#include <sstream>
+#include <algorithm>
 #include <cctype>
+#include <cmath>
 #include <cstring>
-#include <algorithm>
-
+#include <stdexcept>
+
+// Checks the XXX-XX-XXXX SSN format
+bool isValidSSN(const char* ssn) {
+    return (strlen(ssn) == 11) &&
+        (isdigit(ssn[0]) && isdigit(ssn[1]) && isdigit(ssn[2])) &&
+        (ssn[3] == '-') &&
+        (isdigit(ssn[4]) && isdigit(ssn[5])) &&
+        (ssn[6] == '-') &&
+        (isdigit(ssn[7]) && isdigit(ssn[8]) && isdigit(ssn[9]) && isdigit(ssn[10]));
+}
 
-// Constructor - Initializes the database and determines the next available ID
-EmployeeDB::EmployeeDB() {
-    // Open the employee data file in binary mode
-                   // Default starting ID if no records exist
-    std::ifstream file(filename, std::ios::binary);
-    if (!file) {
-        nextId = 1;               // If file doesn't exist, start IDs from 1
-        return;
+// Converts XXX-XX-XXXX into the integer XXXXXXXXX (fits in 30 bits)
+std::uint32_t packSSN(const char* ssn) {
+    std::uint32_t value = 0;
+    for (int i = 0; i < 11; i++) {
+        if (ssn[i] != '-') {
+            value = value * 10 + static_cast<std::uint32_t>(ssn[i] - '0');
+        }
     }
+    return value;
+}
 
-    Employee emp;
-    nextId = 1;
-    // Read through all records to find the highest ID
-    while (file.read(reinterpret_cast<char*>(&emp), sizeof(Employee))) {
-        // Update nextId to be one higher than the maximum found ID
-        if (emp.id >= nextId) {
-            nextId = emp.id + 1;
-        }
+void encodeSSNKey(std::uint32_t packed, unsigned char key[4]) {
+    key[0] = static_cast<unsigned char>(packed >> 24);
+    key[1] = static_cast<unsigned char>(packed >> 16);
+    key[2] = static_cast<unsigned char>(packed >> 8);
+    key[3] = static_cast<unsigned char>(packed);
+}
+
+// Constructor - Initializes the database and determines the next available ID
+EmployeeDB::EmployeeDB()
+    : store(filename), wal(walFilename), directory(metaFilename), indexPages(INDEX_CACHE_BYTES),
+      ssnIndex(ssnIndexFilename, sizeof(std::uint32_t), &indexPages),
+      salaryIndex(salaryIndexFilename, Field::Salary, &indexPages), ageIndex(ageIndexFilename, Field::Age, &indexPages),
+      lastNameIndex(lastNameIndexFilename, Field::LastName, &indexPages) {
+    // A non-empty log means the last run did not shut down cleanly; after
+    // redoing it, everything derived from the data file is rebuilt
+    bool recovered = recover();
+
+    // The superblock already knows the next ID; only rescan the data file
+    // when it was written for a different number of records (missing or stale)
+    if (recovered || !directory.matches(store.size())) {
+        directory.rebuild(store);
+    }
+    nextId = directory.nextId();
+
+    // The index stamp records how many data records it has seen;
+    // a mismatch means the index is missing or stale
+    if (recovered || ssnIndex.stamp() != store.size()) {
+        rebuildSSNIndex();
+    }
+    if (recovered || salaryIndex.stamp() != store.size() || ageIndex.stamp() != store.size() ||
+        lastNameIndex.stamp() != store.size()) {
+        rebuildSecondaryIndexes();
+    }
+    if (recovered || !wal.hasCheckpoint()) {
+        checkpointLocked();
     }
-    file.close();         // Always close the file when done
 }
 
-// Returns the next available ID and increments the counter
-int EmployeeDB::getNextId() {
-    return nextId++;                // Returns current ID, then increments for next call
+EmployeeDB::~EmployeeDB() {
+    try {
+        checkpointLocked();
+    }
+    catch (const std::exception&) {
+        // Nothing is lost: the log still holds every mutation and is replayed on open
+    }
 }
 
-// Adds a new employee to the database with validation
-void EmployeeDB::addEmployee() {
-    Employee emp;
-    emp.id = getNextId();         // Assign the next available ID
-    emp.isDeleted = false;        // New records are active by default
-
-    // Get employee details with input validation
-    std::cout << "Enter First Name (max 20 chars): ";
-    std::cin.getline(emp.firstName, 21);
-    std::cout << "Enter Last Name (max 20 chars): ";   // 20 chars + null terminator
-    std::cin.getline(emp.lastName, 21);
-
-    // Validate SSN format
-    bool validSSN = false;
-    while (!validSSN) {
-        std::cout << "Enter SSN (format XXX-XX-XXXX): ";
-        std::cin.getline(emp.ssn, 12);
-        validSSN = (strlen(emp.ssn) == 11) &&
-            (isdigit(emp.ssn[0]) && isdigit(emp.ssn[1]) && isdigit(emp.ssn[2])) &&
-            (emp.ssn[3] == '-') &&
-            (isdigit(emp.ssn[4]) && isdigit(emp.ssn[5])) &&
-            (emp.ssn[6] == '-') &&
-            (isdigit(emp.ssn[7]) && isdigit(emp.ssn[8]) && isdigit(emp.ssn[9]) && isdigit(emp.ssn[10]));
-
-        if (!validSSN) {
-            std::cout << "Invalid SSN format. Please try again.\n";
+// Redoes the logged mutations on the data file. Appends past both the last
+// checkpoint and the log were never committed and are cut off, along with
+// any torn record at the end. Returns true if the data file changed.
+bool EmployeeDB::recover() {
+    std::size_t committedEnd = wal.hasCheckpoint() ? static_cast<std::size_t>(wal.checkpointRecords()) : store.size();
+    std::size_t replayed = wal.replay([&](const WriteAheadLog::Entry& entry) {
+        std::size_t slot = static_cast<std::size_t>(entry.slot);
+        if (slot < store.size()) {
+            store.write(slot, entry.record);
+        }
+        else if (slot == store.size()) {
+            store.append(entry.record);
         }
         else {
-            // Check for duplicate SSN
-            std::ifstream file(filename, std::ios::binary);
-            Employee temp;
-            while (file.read(reinterpret_cast<char*>(&temp), sizeof(Employee))) {
-                if (!temp.isDeleted && strcmp(temp.ssn, emp.ssn) == 0) {
-                    std::cout << "SSN already exists in database.\n";
-                    validSSN = false;
-                    break;
-                }
-            }
-            file.close();
+            throw std::runtime_error("Write-ahead log " + walFilename + " does not match " + filename);
         }
+        committedEnd = std::max(committedEnd, slot + 1);
+    });
+    bool truncated = store.size() > committedEnd;
+    store.truncate(committedEnd);
+    return replayed > 0 || truncated;
+}
+
+// Counts logged mutations against the commit interval. Returns the lsn the
+// caller must commit once it has released the lock, or 0 when the sync is
+// left to a later mutation.
+std::uint64_t EmployeeDB::logged(std::uint64_t lsn, std::size_t mutations) {
+    uncommitted += mutations;
+    if (uncommitted < commitInterval) {
+        return 0;
     }
+    uncommitted = 0;
+    return lsn;
+}
 
-    std::cout << "Enter Salary: ";
-    std::cin >> emp.salary;
-    std::cout << "Enter Age: ";
-    std::cin >> emp.age;
-    std::cin.ignore();        // Clear leftover newline character
+// Waits for the log sync covering lsn (0: nothing to wait for)
+void EmployeeDB::commitLog(std::uint64_t lsn) {
+    ScopedTimer timer(metrics, Operation::LogSync);
+    wal.commit(lsn);
+}
 
-    // Append new record to binary file
-    std::ofstream file(filename, std::ios::binary | std::ios::app);
-    if (!file) {
-        std::cerr << "Error opening file for writing.\n";
-        return;
+// Called after a logged mutation reached the data file
+void EmployeeDB::maybeCheckpoint() {
+    if (wal.bytes() >= CHECKPOINT_BYTES) {
+        checkpointLocked();
     }
-    // Write the employee struct as binary data
-    file.write(reinterpret_cast<const char*>(&emp), sizeof(Employee));
-    file.close();
-
-    std::cout << "Employee added successfully. ID: " << emp.id << "\n";
 }
 
-// Displays employees with optional sorting
-void EmployeeDB::displayEmployees(bool indexed, int field) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file) {
-        // Open file for reading all employees
-        std::cout << "No employee data found.\n";
-        return;
+// Makes every logged mutation durable now
+void EmployeeDB::sync() {
+    {
+        std::unique_lock<ReadWriteLock> guard(rwLock);
+        uncommitted = 0;
     }
+    wal.sync();
+}
 
-    std::vector<Employee> employees;
-    Employee emp;
+void EmployeeDB::checkpoint() {
+    std::unique_lock<ReadWriteLock> guard(rwLock);
+    checkpointLocked();
+}
+
+// Syncs the data file, which then holds every logged mutation, and empties the
+// log. Cached index pages are written out first: once the log is empty
+// nothing would replay the mutations they hold.
+void EmployeeDB::checkpointLocked() {
+    ScopedTimer timer(metrics, Operation::Checkpoint);
+    flushIndexes();
+    store.sync();
+    wal.checkpoint(store.size());
+    uncommitted = 0;
+}
 
-    // Read all active (non-deleted) employees into vector
-    while (file.read(reinterpret_cast<char*>(&emp), sizeof(Employee))) {
-        if (!emp.isDeleted) {
-            employees.push_back(emp);
+// Rebuilds the SSN index from scratch with a single pass over the data file
+void EmployeeDB::rebuildSSNIndex() {
+    std::vector<std::pair<std::uint32_t, std::uint64_t>> entries;    // (packed SSN, slot)
+    for (std::size_t slot = 0; slot < store.size(); slot++) {
+        const Employee& emp = store.at(slot);
+        if (!emp.isDeleted && isValidSSN(emp.ssn)) {
+            entries.emplace_back(packSSN(emp.ssn), slot);
         }
     }
-    file.close();
 
-    if (employees.empty()) {
-        std::cout << "No employees to display.\n";
-        return;
-    }
+    // Sort by SSN and drop duplicates so bulk loading sees unique keys
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end(),
+        [](const auto& a, const auto& b) { return a.first == b.first; }), entries.end());
 
-    // Sort if indexing requested
-    if (indexed) {
-        switch (field) {
-        case 1: // Sort by salary
-            std::sort(employees.begin(), employees.end(),
-                [](const Employee& a, const Employee& b) { return a.salary < b.salary; });
-            break;
-        case 2: // Sort by Age
-            std::sort(employees.begin(), employees.end(),
-                [](const Employee& a, const Employee& b) { return a.age < b.age; });
-            break;
-        case 3: // Sort by Last Name
-            std::sort(employees.begin(), employees.end(),
-                [](const Employee& a, const Employee& b) { return strcmp(a.lastName, b.lastName) < 0; });
-            break;
-        case 4: // Sort by SSN
-            std::sort(employees.begin(), employees.end(),
-                [](const Employee& a, const Employee& b) { return strcmp(a.ssn, b.ssn) < 0; });
-            break;
-        }
+    std::vector<char> keys(entries.size() * sizeof(std::uint32_t));
+    std::vector<std::uint64_t> values(entries.size());
+    for (std::size_t i = 0; i < entries.size(); i++) {
+        encodeSSNKey(entries[i].first, reinterpret_cast<unsigned char*>(&keys[i * sizeof(std::uint32_t)]));
+        values[i] = entries[i].second;
     }
+    ssnIndex.bulkLoad(keys.data(), values.data(), entries.size());
+    ssnIndex.setStamp(store.size());
+    ssnFilterReady = false;         // Rebuilt (without deleted SSNs) on next use
+}
 
-    // Display all employee records
-    for (const auto& e : employees) {
-        std::cout << "ID: " << e.id << "\n";
-        std::cout << "Name: " << e.firstName << " " << e.lastName << "\n";
-        std::cout << "SSN: " << e.ssn << "\n";
-        std::cout << "Salary: $" << e.salary << "\n";
-        std::cout << "Age: " << e.age << "\n";
-        std::cout << "------------------------\n";
+// Bulk loads the salary, age and lastName indexes from sorted slot lists
+void EmployeeDB::rebuildSecondaryIndexes() {
+    ThreadPool* workers = store.size() >= PARALLEL_MIN_RECORDS ? pool() : nullptr;
+    for (SecondaryIndex* index : { &salaryIndex, &ageIndex, &lastNameIndex }) {
+        index->rebuild(store.data(), store.size(), sorter, workers);
     }
 }
 
-// Deletes an employee record by marking it as deleted (logical deletion)
-void EmployeeDB::deleteEmployee() {
-    int idToDelete;
-    std::cout << "Enter Employee ID to delete: ";
-    std::cin >> idToDelete;
-    std::cin.ignore();
-
-    // Open file in read+write mode to modify records
-    std::fstream file(filename, std::ios::binary | std::ios::in | std::ios::out);
-    if (!file) {
-        std::cout << "Error opening file.\n";
-        return;
+// Writes every index's modified pages, then its header
+void EmployeeDB::flushIndexes() {
+    ssnIndex.flush();
+    for (SecondaryIndex* index : { &salaryIndex, &ageIndex, &lastNameIndex }) {
+        index->flush();
     }
+}
 
-    Employee emp;
-    bool found = false;
-    // Search through all records
-    while (file.read(reinterpret_cast<char*>(&emp), sizeof(Employee))) {
-        if (emp.id == idToDelete && !emp.isDeleted) {
-            found = true;
-            emp.isDeleted = true;    // Mark record as deleted
-
-            // Move write pointer back to start of current record
-            file.seekp(-static_cast<int>(sizeof(Employee)), std::ios::cur);
-            // Write modified record back to file
-            file.write(reinterpret_cast<const char*>(&emp), sizeof(Employee));
-            std::cout << "Employee deleted successfully.\n";
-            break;
-        }
+// Adds one live record to the secondary indexes and brings their stamps up to date
+void EmployeeDB::indexRecord(const Employee& emp, std::size_t slot) {
+    for (SecondaryIndex* index : { &salaryIndex, &ageIndex, &lastNameIndex }) {
+        index->insert(emp, slot);
+        index->setStamp(store.size());
     }
+}
 
-    if (!found) {
-        std::cout << "Employee not found or already deleted.\n";
+void EmployeeDB::unindexRecord(const Employee& emp, std::size_t slot) {
+    for (SecondaryIndex* index : { &salaryIndex, &ageIndex, &lastNameIndex }) {
+        index->erase(emp, slot);
     }
-    file.close();      // Always close the file
 }
 
+// Returns the next available ID and increments the counter
+int EmployeeDB::getNextId() {
+    return nextId++;                // Returns current ID, then increments for next call
+}
 
-// Merge function for merge sort - combines two sorted subarrays
-void EmployeeDB::merge(std::vector<std::pair<int, std::string>>& arr, int l, int m, int r, bool ascending) {
-    int n1 = m - l + 1;            // Size of left subarray
-    int n2 = r - m;                // Size of right subarray
-
-    // Create temporary arrays
-    std::vector<std::pair<int, std::string>> L(n1), R(n2);
+// Validates and appends a new employee; the ID is assigned here
+int EmployeeDB::insert(const Employee& input) {
+    ScopedTimer timer(metrics, Operation::Insert);
+    Employee emp = input;
+    emp.firstName[20] = '\0';      // Never trust terminators coming from the caller
+    emp.lastName[20] = '\0';
+    emp.ssn[11] = '\0';
+    emp.isDeleted = false;          // New records are active by default
 
-    // Copy data to temp arrays
-    for (int i = 0; i < n1; i++)
-        L[i] = arr[l + i];
-    for (int j = 0; j < n2; j++)
-        R[j] = arr[m + 1 + j];
+    if (!isValidSSN(emp.ssn)) {
+        throw std::invalid_argument("Invalid SSN format");
+    }
+    // NaN would break the ordering sorts rely on and poison SUM/AVG
+    if (!std::isfinite(emp.salary)) {
+        throw std::invalid_argument("Invalid salary");
+    }
 
-    // Merge the temp arrays back into arr
-    int i = 0, j = 0, k = l;         // Initial indexes
-    while (i < n1 && j < n2) {
-        // Compare elements based on sort order (ascending/descending)
-        bool condition = ascending ? (L[i].second < R[j].second) : (L[i].second > R[j].second);
-        if (condition) {
-            arr[k] = L[i];      // Take from left array
-            i++;
+    std::uint64_t commitLsn;
+    {
+        std::unique_lock<ReadWriteLock> guard(rwLock);
+        if (ssnExists(emp.ssn)) {
+            throw std::invalid_argument("SSN already exists in database");
         }
-        else {
-            arr[k] = R[j];     // Take from right array
-            j++;
+        emp.id = getNextId();
+
+        // Log, then append the new record to the end of the data file
+        commitLsn = logged(wal.append(WriteAheadLog::Op::Insert, store.size(), &emp, 1), 1);
+        std::size_t slot = store.append(emp);
+        directory.recordInsert(emp.id, slot);
+
+        // Record the new slot in the SSN index
+        unsigned char key[4];
+        encodeSSNKey(packSSN(emp.ssn), key);
+        ssnIndex.insert(key, slot);
+        ssnIndex.setStamp(store.size());
+        noteSSN(emp.ssn);
+        indexRecord(emp, slot);
+        maybeCheckpoint();
+    }
+    // Waiting for the sync outside the lock lets other writers join the same one
+    commitLog(commitLsn);
+    return emp.id;
+}
+
+// Wraps result slots over the current mapping
+QueryResult EmployeeDB::makeResult(SlotBuffer slots, std::vector<Field> fields) const {
+    QueryResult result;
+    result.records = store.data();
+    result.mapping = store.pin();
+    result.slots = std::move(slots);
+    result.fields = std::move(fields);
+    metrics.count(Event::RowsReturned, result.slots.size());
+    return result;
+}
+
+// All active (non-deleted) employees in file order
+QueryResult EmployeeDB::employees() {
+    ScopedTimer timer(metrics, Operation::Employees);
+    std::shared_lock<ReadWriteLock> guard(rwLock);
+    SlotBuffer slots;
+    slots.reserve(static_cast<std::size_t>(directory.liveCount()));
+    for (std::size_t slot = 0; slot < store.size(); slot++) {
+        if (!store.at(slot).isDeleted) {
+            slots.push_back(slot);
         }
-        k++;
     }
+    return makeResult(std::move(slots));
+}
 
-    // Copy remaining elements of L[] if any
-    while (i < n1) {
-        arr[k] = L[i];
-        i++;
-        k++;
+// Active employees ordered by one field. The order computed last time is
+// kept, so a repeat sort only radix sorts the records appended since and
+// splices them in. Sorting happens in the sorter's reusable scratch arrays;
+// concurrent sorts that find the shared sorter busy use a sorter of their own.
+QueryResult EmployeeDB::sortedBy(int field, bool ascending) {
+    static const Field fields[] = { Field::Salary, Field::Age, Field::LastName, Field::SSN };
+    if (field < 1 || field > 4) {
+        throw std::invalid_argument("Unknown sort field " + std::to_string(field));
+    }
+    ScopedTimer timer(metrics, Operation::SortedBy);
+    std::shared_lock<ReadWriteLock> guard(rwLock);
+    SlotBuffer slots;
+    ThreadPool* workers = store.size() >= PARALLEL_MIN_RECORDS ? pool() : nullptr;
+    std::unique_lock<std::mutex> sorterGuard(sorterLock, std::try_to_lock);
+    RecordSorter own;
+    RecordSorter& use = sorterGuard.owns_lock() ? sorter : own;
+    if (!sortOrderReuse) {
+        std::vector<std::size_t> sorted;
+        use.sortLive(store.data(), store.size(), fields[field - 1], ascending, sorted, workers);
+        slots.assign(sorted.begin(), sorted.end());
+    }
+    else if (sortOrders.sortLive(store.data(), store.size(), fields[field - 1], ascending, slots, use, workers)) {
+        metrics.count(Event::SortsReused);
+    }
+    return makeResult(std::move(slots));
+}
+
+void EmployeeDB::setSortOrderReuse(bool enabled) {
+    std::unique_lock<ReadWriteLock> guard(rwLock);
+    sortOrderReuse = enabled;
+    if (!enabled) {
+        sortOrders.clear();
     }
+}
 
-    // Copy remaining elements of R[] if any
-    while (j < n2) {
-        arr[k] = R[j];
-        j++;
-        k++;
+// Worker pool for parallel scans and sorts, created on first use;
+// nullptr when configured (or limited by the hardware) to one thread
+ThreadPool* EmployeeDB::pool() {
+    std::lock_guard<std::mutex> guard(poolLock);
+    if (!threadPool) {
+        std::size_t threads = threadCount ? threadCount : std::thread::hardware_concurrency();
+        if (threads <= 1) {
+            return nullptr;
+        }
+        threadPool = std::make_unique<ThreadPool>(threads);
     }
+    return threadPool.get();
 }
 
-// Recursive merge sort implementation
-void EmployeeDB::mergeSort(std::vector<std::pair<int, std::string>>& arr, int l, int r, bool ascending) {
-    if (l >= r) return;            // Base case: subarray of size 1 is already sorted
+void EmployeeDB::setThreadCount(std::size_t threads) {
+    std::unique_lock<ReadWriteLock> guard(rwLock);
+    threadCount = threads;
+    threadPool.reset();
+}
 
-    int m = l + (r - l) / 2;      // Find midpoint
-    mergeSort(arr, l, m, ascending);         // Sort first half
-    mergeSort(arr, m + 1, r, ascending);     // Sort second half
-    merge(arr, l, m, r, ascending);          // Merge sorted halves
+void EmployeeDB::setColumnarScans(bool enabled) {
+    std::unique_lock<ReadWriteLock> guard(rwLock);
+    columnarScans = enabled;
 }
 
-// Indexes employees by specified field using merge sort
-void EmployeeDB::indexByField(int field, bool ascending) {
-    // Open employee data file
-    std::ifstream file(filename, std::ios::binary);
-    if (!file) {
-        std::cout << "No employee data found.\n";
-        return;
+void EmployeeDB::setCompactionThreshold(double ratio) {
+    std::unique_lock<ReadWriteLock> guard(rwLock);
+    compactionThreshold = ratio;
+}
+
+void EmployeeDB::setIndexCacheSize(std::size_t bytes) {
+    std::unique_lock<ReadWriteLock> guard(rwLock);
+    indexPages.setCapacity(bytes);
+}
+
+void EmployeeDB::setCommitInterval(std::size_t mutations) {
+    std::unique_lock<ReadWriteLock> guard(rwLock);
+    commitInterval = mutations ? mutations : 1;
+}
+
+std::size_t EmployeeDB::recordCount() const {
+    std::shared_lock<ReadWriteLock> guard(rwLock);
+    return store.size();
+}
+
+std::size_t EmployeeDB::liveCount() const {
+    std::shared_lock<ReadWriteLock> guard(rwLock);
+    return static_cast<std::size_t>(directory.liveCount());
+}
+
+// Metrics plus the I/O counters of every file behind the database
+MetricsSnapshot EmployeeDB::stats() const {
+    MetricsSnapshot snapshot = metrics.snapshot();
+    snapshot.dataFile = store.io().snapshot();
+    snapshot.log = wal.io().snapshot();
+    snapshot.indexes = ssnIndex.io().snapshot();
+    for (const SecondaryIndex* index : { &salaryIndex, &ageIndex, &lastNameIndex }) {
+        snapshot.indexes += index->io().snapshot();
+    }
+    snapshot.indexCache = indexPages.stats();
+    return snapshot;
+}
+
+// Resolves an ID to the slot of its live record through the id hash index
+bool EmployeeDB::findLiveSlot(int id, std::size_t& slot) {
+    // Loaded once up front so concurrent readers never race to fill it
+    std::call_once(directoryLoaded, [this]() { directory.preload(); });
+    return directory.find(id, slot) && slot < store.size() &&
+        store.at(slot).id == id && !store.at(slot).isDeleted;
+}
+
+// Finds the live record holding a valid SSN. A Bloom filter miss proves
+// the SSN is absent without reading any index pages; only filter hits
+// (real matches, deleted SSNs and ~1% false hits) probe the B+tree, and
+// the record it points at is double-checked.
+bool EmployeeDB::findSSNSlot(const char* ssn, std::size_t& slot) {
+    {
+        // A reader may be the first to need the filter, so building it is
+        // serialized; once built it only changes under the exclusive lock
+        std::lock_guard<std::mutex> filterGuard(ssnFilterLock);
+        if (!ssnFilterReady || ssnFilter.size() >= ssnFilter.capacity()) {
+            rebuildSSNFilter();     // First use, or full enough to lose precision
+        }
+    }
+    if (!ssnFilter.mightContain(packSSN(ssn))) {
+        metrics.count(Event::FilterRejects);
+        return false;
     }
+    metrics.count(Event::IndexProbes);
+    unsigned char key[4];
+    encodeSSNKey(packSSN(ssn), key);
+    std::uint64_t found;
+    if (!ssnIndex.find(key, found) || found >= store.size()) {
+        return false;
+    }
+    const Employee& emp = store.at(static_cast<std::size_t>(found));
+    if (emp.isDeleted || strcmp(emp.ssn, ssn) != 0) {
+        return false;
+    }
+    slot = static_cast<std::size_t>(found);
+    return true;
+}
 
-    // Create vector to store ID-field pairs for sorting
-    std::vector<std::pair<int, std::string>> idAndField;
-    Employee emp;
-
-    // Read all active employees and extract relevant field
-    while (file.read(reinterpret_cast<char*>(&emp), sizeof(Employee))) {
-        if (!emp.isDeleted) {
-            std::string fieldValue;
-            switch (field) {
-            case 1: fieldValue = std::to_string(emp.salary); break; // Salary
-            case 2: fieldValue = std::to_string(emp.age); break;   // Age
-            case 3: fieldValue = emp.lastName; break;              // Last Name
-            case 4: fieldValue = emp.ssn; break;                  // SSN
-            default: break;
-            }
-            idAndField.emplace_back(emp.id, fieldValue);
+// Loads the SSN of every live record into the Bloom filter, leaving room
+// for the table to double before it needs rebuilding
+void EmployeeDB::rebuildSSNFilter() {
+    ssnFilter.reset(std::max<std::size_t>(MIN_FILTER_KEYS, static_cast<std::size_t>(directory.liveCount()) * 2));
+    for (const Employee& emp : store) {
+        if (!emp.isDeleted && isValidSSN(emp.ssn)) {
+            ssnFilter.add(packSSN(emp.ssn));
         }
     }
-    file.close();
+    ssnFilterReady = true;
+}
 
-    if (idAndField.empty()) {
-        std::cout << "No employees to index.\n";
-        return;
+// Duplicate check for a valid SSN
+bool EmployeeDB::ssnExists(const char* ssn) {
+    ScopedTimer timer(metrics, Operation::DuplicateCheck);
+    std::size_t slot;
+    return findSSNSlot(ssn, slot);
+}
+
+// Adds the SSN of a newly written record to the filter
+void EmployeeDB::noteSSN(const char* ssn) {
+    if (ssnFilterReady) {
+        ssnFilter.add(packSSN(ssn));
     }
+}
 
-    // Sort the ID-field pairs using merge sort
-    mergeSort(idAndField, 0, idAndField.size() - 1, ascending);
+std::optional<Employee> EmployeeDB::findById(int id) {
+    ScopedTimer timer(metrics, Operation::FindById);
+    std::shared_lock<ReadWriteLock> guard(rwLock);
+    std::size_t slot;
+    if (!findLiveSlot(id, slot)) {
+        return std::nullopt;
+    }
+    return store.at(slot);
+}
 
-    // Display sorted results
-    std::cout << "Employees indexed by field " << field << " ("
-        << (ascending ? "ascending" : "descending") << "):\n";
-    std::ifstream displayFile(filename, std::ios::binary);
-    for (const auto& pair : idAndField) {
-        // Seek to the correct record position
-        displayFile.seekg((pair.first - 1) * sizeof(Employee));
-        displayFile.read(reinterpret_cast<char*>(&emp), sizeof(Employee));
+// Bloom filter check, then O(log n) page reads through the on-disk SSN index
+std::optional<Employee> EmployeeDB::findBySSN(std::string_view ssn) {
+    ScopedTimer timer(metrics, Operation::FindBySSN);
+    char text[12];
+    if (ssn.size() != 11) {
+        return std::nullopt;
+    }
+    std::memcpy(text, ssn.data(), 11);
+    text[11] = '\0';
+    std::shared_lock<ReadWriteLock> guard(rwLock);
+    std::size_t slot;
+    if (!isValidSSN(text) || !findSSNSlot(text, slot)) {
+        return std::nullopt;
+    }
+    return store.at(slot);
+}
 
-        // Display the requested field
-        std::cout << "ID: " << emp.id << " - ";
-        switch (field) {
-        case 1: std::cout << "Salary: $" << emp.salary; break;
-        case 2: std::cout << "Age: " << emp.age; break;
-        case 3: std::cout << "Last Name: " << emp.lastName; break;
-        case 4: std::cout << "SSN: " << emp.ssn; break;
+// Deletes an employee record by marking it as deleted (logical deletion)
+bool EmployeeDB::erase(int id) {
+    ScopedTimer timer(metrics, Operation::Erase);
+    std::uint64_t commitLsn;
+    {
+        std::unique_lock<ReadWriteLock> guard(rwLock);
+        std::uint64_t lsn;
+        if (!eraseLocked(id, lsn)) {
+            return false;
         }
-        std::cout << "\n";
+        commitLsn = logged(lsn, 1);
+        maybeCheckpoint();
+        maybeCompact();
     }
-    displayFile.close();
+    commitLog(commitLsn);
+    return true;
 }
 
-// Searches for an employee by SSN using binary search
-void EmployeeDB::searchBySSN() {
-    char searchSSN[12];               // Buffer to store SSN input (11 chars + null terminator)
-    std::cout << "Enter SSN to search (XXX-XX-XXXX): ";
-    std::cin.getline(searchSSN, 12);        // Get SSN from user
+// Marks an employee deleted and unindexes it; sets lsn to the log record
+// to commit. False if no active employee has this ID.
+bool EmployeeDB::eraseLocked(int id, std::uint64_t& lsn) {
+    // One hash lookup, one read of the mapped record and one positioned write
+    std::size_t slot;
+    if (!findLiveSlot(id, slot)) {
+        return false;
+    }
+
+    Employee emp = store.at(slot);
+    emp.isDeleted = true;    // Mark record as deleted
+
+    // Log, then write the modified record back in place
+    lsn = wal.append(WriteAheadLog::Op::Delete, slot, &emp, 1);
+    store.write(slot, emp);
+    columns.update(slot, emp);
+    directory.recordDelete(emp.id);
+
+    // Deleted employees no longer own their SSN
+    unsigned char key[4];
+    encodeSSNKey(packSSN(emp.ssn), key);
+    ssnIndex.erase(key);
+    unindexRecord(emp, slot);
+    return true;
+}
+
+std::size_t EmployeeDB::compact() {
+    std::unique_lock<ReadWriteLock> guard(rwLock);
+    return compactLocked();
+}
 
-    // First index by SSN for binary search
-    std::ifstream file(filename, std::ios::binary);
-    if (!file) {
-        std::cout << "No employee data found.\n";
+// Rewrites the data file without tombstones and rebuilds everything keyed by slot.
+// Results still pinning the old mapping keep reading the old file.
+std::size_t EmployeeDB::compactLocked() {
+    if (directory.liveCount() == store.size()) {
+        return 0;                   // Nothing to reclaim
+    }
+    ScopedTimer timer(metrics, Operation::Compact);
+    checkpointLocked();             // Logged slots are about to change meaning
+    std::size_t removed = store.compact();
+    wal.checkpoint(store.size());
+    directory.rebuild(store);
+    rebuildSSNIndex();
+    rebuildSecondaryIndexes();
+    flushIndexes();                 // The log no longer covers the old file
+    columns.clear();                // Rebuilt lazily from the new file
+    sortOrders.clear();             // Kept orders name old slots
+    return removed;
+}
+
+// Compacts automatically once deleted rows make up too much of the file
+void EmployeeDB::maybeCompact() {
+    std::size_t total = store.size();
+    if (compactionThreshold <= 0.0 || total < MIN_COMPACTION_RECORDS) {
         return;
     }
+    double deadRatio = static_cast<double>(total - directory.liveCount()) / static_cast<double>(total);
+    if (deadRatio > compactionThreshold) {
+        compactLocked();
+    }
+}
 
-    // Create vector to store (employee ID, SSN) pairs
-    std::vector<std::pair<int, std::string>> ssnIndex;
-    Employee emp;
-
-    // Read all active employees and store their SSNs with IDs
-    while (file.read(reinterpret_cast<char*>(&emp), sizeof(Employee))) {
-        if (!emp.isDeleted) {
-            ssnIndex.emplace_back(emp.id, emp.ssn);    // Store ID-SSN pair
+// Answers the plan through the SSN index or an ordered index when its access
+// path allows; false means the caller has to scan the whole file instead
+bool EmployeeDB::probeIndexes(const QueryPlan& plan, std::size_t cap, SlotBuffer& slots) {
+    if (plan.access == QueryPlan::Access::FullScan) {
+        return false;
+    }
+    ScopedTimer timer(metrics, Operation::IndexScan);
+    if (plan.access == QueryPlan::Access::SSNLookup) {
+        // Index probe: at most one candidate row, checked against the full filter
+        metrics.count(Event::IndexProbes);
+        unsigned char key[4];
+        encodeSSNKey(plan.ssnKey, key);
+        std::uint64_t slot;
+        if (cap > 0 && ssnIndex.find(key, slot) && slot < store.size() &&
+            !store.at(slot).isDeleted && matchesRow(plan.filter, store.at(slot))) {
+            slots.push_back(static_cast<std::size_t>(slot));
         }
+        return true;
     }
-    file.close();
-
-    if (ssnIndex.empty()) {
-        std::cout << "No employees to search.\n";
-        return;
+    if (scanIndexRange(plan, std::max<std::size_t>(1, store.size() / INDEX_SCAN_FRACTION), slots)) {
+        metrics.count(Event::IndexRangeScans);
+        return true;
     }
+    metrics.count(Event::IndexFallbacks);
+    slots.clear();
+    return false;
+}
 
-    // Sort SSNs for binary search
-    mergeSort(ssnIndex, 0, ssnIndex.size() - 1, true);
-
-    // Binary search implementation
-    int left = 0;                     // Start of search range
-    int right = ssnIndex.size() - 1;  // End of search range
-    bool found = false;               // Search result flag
-    int foundId = -1;                 // ID of found employee
-
-    while (left <= right) {
-        int mid = left + (right - left) / 2;           // Calculate midpoint (avoids overflow)
+// True if full scans of this plan should use the column kernels; brings
+// the column copy up to date first
+bool EmployeeDB::prepareColumns(const QueryPlan& plan) {
+    bool columnar = columnarScans && plan.hasFilter;
+    if (columnar) {
+        std::lock_guard<std::mutex> columnsGuard(columnsLock);
+        columns.sync(store);
+    }
+    return columnar;
+}
 
-        // Compare search SSN with middle element's SSN
-        int cmp = strcmp(ssnIndex[mid].second.c_str(), searchSSN);
+// Appends the live slots in [begin, end) that match the filter to out,
+// stopping once out holds limit slots. Bitmaps come from out's memory
+// resource, so pass a buffer on the query's arena (or on the heap).
+void EmployeeDB::scanSlots(const QueryPlan& plan, bool columnar, std::size_t begin, std::size_t end,
+    std::size_t limit, SlotBuffer& out) const {
+    if (columnar) {
+        // Vectorized scan: one selection bitmap per predicate, combined word by word
+        SelectionBitmap selected(out.get_allocator()), live(out.get_allocator());
+        evaluatePredicate(plan.filter, columns, begin, end, selected);
+        columns.liveRows(begin, end, live);
+        intersectBitmaps(selected, live);
+        std::size_t matched = 0;
+        for (std::uint64_t word : selected) {
+            matched += static_cast<std::size_t>(__builtin_popcountll(word));
+        }
+        if (out.size() < limit) {
+            out.reserve(out.size() + std::min(matched, limit - out.size()));    // Exactly what is kept
+        }
+        forEachSelected(selected, [&](std::size_t slot) {
+            if (out.size() < limit) {
+                out.push_back(slot);
+            }
+        }, begin);
+        std::size_t liveRows = 0;
+        for (std::uint64_t word : live) {
+            liveRows += static_cast<std::size_t>(__builtin_popcountll(word));
+        }
+        metrics.count(Event::RecordsScanned, end - begin);
+        metrics.count(Event::TombstonesSkipped, end - begin - liveRows);
+        return;
+    }
+    // Row-at-a-time scan with typed comparisons. Counts are kept locally and
+    // published once per call so the loop never touches shared counters.
+    std::size_t slot = begin;
+    std::size_t tombstones = 0;
+    for (; slot < end && out.size() < limit; slot++) {
+        const Employee& emp = store.at(slot);
+        if (emp.isDeleted) {
+            tombstones++;
+        }
+        else if (!plan.hasFilter || matchesRow(plan.filter, emp)) {
+            out.push_back(slot);
+        }
+    }
+    metrics.count(Event::RecordsScanned, slot - begin);
+    metrics.count(Event::TombstonesSkipped, tombstones);
+    metrics.count(Event::BytesScanned, (slot - begin) * sizeof(Employee));
+}
 
-        if (cmp == 0) {                // Exact match found
-            found = true;
-            foundId = ssnIndex[mid].first;        // Store the employee ID
-            break;
+// Runs a compiled plan and returns the matching record slots in output
+// order. The result is collected on the heap; only temporaries (bitmaps,
+// per-chunk matches) come from the arena.
+SlotBuffer EmployeeDB::executePlan(const QueryPlan& plan, QueryArena& arena) {
+    SlotBuffer slots;
+    // Without ORDER BY the scan can stop as soon as LIMIT rows are found
+    std::size_t cap = (plan.orderBy.empty() && plan.limit >= 0)
+        ? static_cast<std::size_t>(plan.limit) : store.size();
+
+    if (!probeIndexes(plan, cap, slots)) {
+        ScopedTimer timer(metrics, Operation::FullScan);
+        bool columnar = prepareColumns(plan);
+        std::size_t n = store.size();
+        ThreadPool* workers = (cap >= n && n >= PARALLEL_MIN_RECORDS) ? pool() : nullptr;
+        if (workers) {
+            // Chunks are scanned on the pool and concatenated in file order
+            std::size_t chunks = (n + PARALLEL_SCAN_CHUNK - 1) / PARALLEL_SCAN_CHUNK;
+            std::pmr::vector<SlotBuffer> parts(chunks, &arena);
+            workers->parallelFor(chunks, [&](std::size_t c) {
+                std::size_t begin = c * PARALLEL_SCAN_CHUNK;
+                scanSlots(plan, columnar, begin, std::min(n, begin + PARALLEL_SCAN_CHUNK), n, parts[c]);
+            });
+            std::size_t total = 0;
+            for (const SlotBuffer& part : parts) {
+                total += part.size();
+            }
+            slots.reserve(total);
+            for (const SlotBuffer& part : parts) {
+                slots.insert(slots.end(), part.begin(), part.end());
+            }
         }
-        else if (cmp < 0) {            // Search SSN is in right half
-            left = mid + 1;
+        else {
+            scanSlots(plan, columnar, 0, n, cap, slots);
         }
-        else {                        // Search SSN is in left half
-            right = mid - 1;
+    }
+    orderAndLimit(plan, slots);
+    return slots;
+}
+
+// Puts matching slots into the plan's output order and applies LIMIT
+void EmployeeDB::orderAndLimit(const QueryPlan& plan, SlotBuffer& slots) const {
+    ScopedTimer timer(metrics, Operation::Order);
+    if (plan.access == QueryPlan::Access::IndexRange && plan.orderBy.empty() && !slots.empty()) {
+        // Index scans produce value order; without ORDER BY results are in file
+        // order (which also makes LIMIT pick the same rows as a full scan)
+        std::sort(slots.begin(), slots.end());
+    }
+
+    if (!plan.orderBy.empty()) {
+        // Ties keep file order so results are deterministic
+        auto before = [&](std::size_t a, std::size_t b) {
+            if (orderBefore(plan.orderBy, store.at(a), store.at(b))) return true;
+            if (orderBefore(plan.orderBy, store.at(b), store.at(a))) return false;
+            return a < b;
+        };
+        if (plan.limit >= 0 && static_cast<std::size_t>(plan.limit) < slots.size()) {
+            // Only the first LIMIT rows need to be in order
+            std::partial_sort(slots.begin(), slots.begin() + plan.limit, slots.end(), before);
+        }
+        else {
+            std::sort(slots.begin(), slots.end(), before);
         }
     }
+    if (plan.limit >= 0 && static_cast<std::size_t>(plan.limit) < slots.size()) {
+        slots.resize(static_cast<std::size_t>(plan.limit));
+    }
+}
 
-    if (found) {
-        // Display the found record
-        std::ifstream file(filename, std::ios::binary);    // Seek to record position
-        file.seekg((foundId - 1) * sizeof(Employee));      // Read record
-        file.read(reinterpret_cast<char*>(&emp), sizeof(Employee));
-        std::cout << "Employee found:\n";
-        std::cout << "ID: " << emp.id << "\n";
-        std::cout << "Name: " << emp.firstName << " " << emp.lastName << "\n";
-        std::cout << "SSN: " << emp.ssn << "\n";
-        std::cout << "Salary: $" << emp.salary << "\n";
-        std::cout << "Age: " << emp.age << "\n";
-        file.close();
+// Runs an aggregate plan in one pass: matching rows are folded into a hash
+// aggregation table chunk by chunk, with one table per chunk on the pool for
+// large files, and the partial tables are merged at the end. Only the group
+// rows are materialized, never the matching slots of the whole file.
+AggregateTable EmployeeDB::executeAggregate(const QueryPlan& plan, QueryArena& arena) {
+    HashAggregator total(plan, store.data(), &arena);
+    SlotBuffer slots(&arena);
+    if (probeIndexes(plan, store.size(), slots)) {
+        for (std::size_t slot : slots) {
+            total.add(slot);
+        }
+        return total.finish();
+    }
+
+    ScopedTimer timer(metrics, Operation::FullScan);
+    bool columnar = prepareColumns(plan);
+    std::size_t n = store.size();
+    std::size_t chunks = (n + PARALLEL_SCAN_CHUNK - 1) / PARALLEL_SCAN_CHUNK;
+    ThreadPool* workers = n >= PARALLEL_MIN_RECORDS ? pool() : nullptr;
+    if (workers) {
+        std::vector<HashAggregator> parts;
+        parts.reserve(chunks);
+        for (std::size_t c = 0; c < chunks; c++) {
+            parts.emplace_back(plan, store.data(), &arena);
+        }
+        workers->parallelFor(chunks, [&](std::size_t c) {
+            SlotBuffer matches(&arena);
+            std::size_t begin = c * PARALLEL_SCAN_CHUNK;
+            scanSlots(plan, columnar, begin, std::min(n, begin + PARALLEL_SCAN_CHUNK), n, matches);
+            for (std::size_t slot : matches) {
+                parts[c].add(slot);
+            }
+        });
+        for (const HashAggregator& part : parts) {
+            total.merge(part);
+        }
     }
     else {
-        std::cout << "Employee with SSN " << searchSSN << " not found.\n";
+        // One chunk's worth of slots at a time keeps the buffer small
+        for (std::size_t begin = 0; begin < n; begin += PARALLEL_SCAN_CHUNK) {
+            slots.clear();
+            scanSlots(plan, columnar, begin, std::min(n, begin + PARALLEL_SCAN_CHUNK), n, slots);
+            for (std::size_t slot : slots) {
+                total.add(slot);
+            }
+        }
     }
+    return total.finish();
 }
 
-// Executes SQL-like queries on employee records
-void EmployeeDB::runQuery(const std::string& query) {
-    std::istringstream iss(query);
-    std::string token;
-    std::vector<std::string> tokens;
-
-    while (iss >> token) {       // Split query by spaces
-        tokens.push_back(token);
+// Collects the live rows matching the plan through an ordered index: the SSN
+// B+tree or one of the secondary indexes. Returns false (the caller falls
+// back to a full scan) once more than budget candidates turn up, as the
+// range is then too wide for per-row index visits to pay off.
+bool EmployeeDB::scanIndexRange(const QueryPlan& plan, std::size_t budget, SlotBuffer& slots) {
+    const IndexRange& range = plan.range;
+    std::size_t visited = 0;
+    auto visit = [&](std::size_t slot) {
+        if (++visited > budget) {
+            return false;
+        }
+        // The index only narrows the candidates; the whole filter decides
+        if (slot < store.size() && !store.at(slot).isDeleted && matchesRow(plan.filter, store.at(slot))) {
+            slots.push_back(slot);
+        }
+        return true;
+    };
+
+    if (range.field == Field::SSN) {
+        // SSNs are unique and packed, so exclusive bounds are just off by one
+        std::uint32_t low = range.hasLow ? packSSN(range.low.text.c_str()) : 0;
+        std::uint32_t high = range.hasHigh ? packSSN(range.high.text.c_str()) : UINT32_MAX;
+        if ((range.hasLow && !range.lowInclusive && low++ == UINT32_MAX) ||
+            (range.hasHigh && !range.highInclusive && high-- == 0) || low > high) {
+            return true;
+        }
+        unsigned char from[4];
+        encodeSSNKey(low, from);
+        ssnIndex.scan(from, [&](const char* key, std::uint64_t slot) {
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(key);
+            std::uint32_t packed = (std::uint32_t(bytes[0]) << 24) | (std::uint32_t(bytes[1]) << 16) |
+                (std::uint32_t(bytes[2]) << 8) | std::uint32_t(bytes[3]);
+            return packed <= high && visit(static_cast<std::size_t>(slot));
+        });
     }
-
-    // Validate basic query structure: must start with SELECT and have minimum tokens
-    if (tokens.size() < 3 || tokens[0] != "SELECT") {
-        std::cout << "Invalid query format.\n";
-        return;
+    else {
+        SecondaryIndex& index = range.field == Field::Salary ? salaryIndex :
+            range.field == Field::Age ? ageIndex : lastNameIndex;
+        index.scan(range, visit);
     }
+    return visited <= budget;
+}
 
-    // Determine if query wants all fields or specific ones
-    bool selectAll = tokens[1] == "*";
-    std::string fieldName;
-    if (!selectAll) {
-        fieldName = tokens[1];         // Get the specific field to select
-    }
+// Executes SQL-like queries on employee records
+QueryResult EmployeeDB::query(const std::string& text) {
+    return run(planQuery(text));
+}
 
-    // Parse WHERE clause if present
-    bool hasWhere = false;
-    std::string whereField, whereValue;
-    if (tokens.size() > 3 && tokens[3] == "WHERE") {
-        hasWhere = true;
-        whereField = tokens[4];         // Field to filter by
-        whereValue = tokens[6];         // Value to match
+// Compiles a query into an executable plan through the statement cache:
+// queries that differ only in their literals share one cached plan, so
+// repeated shapes skip parsing and planning entirely
+QueryPlan EmployeeDB::planQuery(const std::string& text) {
+    std::vector<std::string> literals;
+    std::string normalized = normalizeQuery(text, literals);
+    return bindQuery(*statementCache.get(normalized), literals);
+}
 
-        // Remove quotes from string values if present
-        if (whereValue.front() == '\'' && whereValue.back() == '\'') {
-            whereValue = whereValue.substr(1, whereValue.length() - 2);
+// Runs several plans under one shared lock. Plans answered by an index run
+// on their own; the rest share a single pass over the file, each chunk
+// being filtered for every plan while it is hot in cache (chunks go to the
+// thread pool for large files). Results come back in plan order.
+std::vector<QueryResult> EmployeeDB::queryBatch(const std::vector<QueryPlan>& plans) {
+    ScopedTimer timer(metrics, Operation::QueryBatch);
+    std::shared_lock<ReadWriteLock> guard(rwLock);
+    ArenaLease lease(queryArena, arenaLock);
+    QueryArena& arena = lease.arena();
+    std::vector<QueryResult> results(plans.size());
+    std::vector<SlotBuffer> matches(plans.size());      // Results, so on the heap
+    std::vector<std::size_t> scanned;           // Plans left for the shared scan
+    for (std::size_t p = 0; p < plans.size(); p++) {
+        const QueryPlan& plan = plans[p];
+        std::size_t cap = (plan.orderBy.empty() && plan.limit >= 0 && plan.aggregates.empty())
+            ? static_cast<std::size_t>(plan.limit) : store.size();
+        if (!probeIndexes(plan, cap, matches[p])) {
+            scanned.push_back(p);
         }
     }
 
-    std::ifstream file(filename, std::ios::binary);
-    if (!file) {
-        std::cout << "No employee data found.\n";
-        return;
+    std::vector<bool> columnar(plans.size(), false);
+    for (std::size_t p : scanned) {
+        columnar[p] = prepareColumns(plans[p]);
+    }
+    std::size_t n = store.size();
+    std::size_t chunks = (n + PARALLEL_SCAN_CHUNK - 1) / PARALLEL_SCAN_CHUNK;
+    // parts[i][c]: matches of scanned plan i in chunk c; aggregate plans
+    // fold their matches into groups[i][c] instead
+    std::pmr::vector<std::pmr::vector<SlotBuffer>> parts(scanned.size(), &arena);
+    for (std::pmr::vector<SlotBuffer>& chunkParts : parts) {
+        chunkParts.resize(chunks);
+    }
+    std::vector<std::vector<HashAggregator>> groups(scanned.size());
+    for (std::size_t i = 0; i < scanned.size(); i++) {
+        if (!plans[scanned[i]].aggregates.empty()) {
+            groups[i].reserve(chunks);
+            for (std::size_t c = 0; c < chunks; c++) {
+                groups[i].emplace_back(plans[scanned[i]], store.data(), &arena);
+            }
+        }
     }
-
-    Employee emp;
-    bool foundAny = false;              // Track if any matches were found
-
-    // Process each employee record
-    while (file.read(reinterpret_cast<char*>(&emp), sizeof(Employee))) {
-        if (!emp.isDeleted) {           // Skip deleted records
-            bool matchesWhere = true;
-
-            // Apply WHERE clause filtering if present
-            if (hasWhere) {
-                if (whereField == "ssn") {
-                    matchesWhere = strcmp(emp.ssn, whereValue.c_str()) == 0;
-                }
-                else if (whereField == "lastName") {
-                    matchesWhere = strcmp(emp.lastName, whereValue.c_str()) == 0;
-                }
-                else if (whereField == "salary") {
-                    matchesWhere = emp.salary == std::stof(whereValue);     // Convert string to float
-                }
-                else if (whereField == "age") {
-                    matchesWhere = emp.age == std::stoi(whereValue);       // Convert string to int
+    auto scanChunk = [&](std::size_t c) {
+        std::size_t begin = c * PARALLEL_SCAN_CHUNK;
+        std::size_t end = std::min(n, begin + PARALLEL_SCAN_CHUNK);
+        for (std::size_t i = 0; i < scanned.size(); i++) {
+            scanSlots(plans[scanned[i]], columnar[scanned[i]], begin, end, n, parts[i][c]);
+            if (!groups[i].empty()) {
+                for (std::size_t slot : parts[i][c]) {
+                    groups[i][c].add(slot);
                 }
+                parts[i][c].clear();
             }
-
-
-            // Display record if it matches the query
-            if (matchesWhere) {
-                foundAny = true;
-                if (selectAll) {
-                    // Display all fields
-                    std::cout << "ID: " << emp.id << "\n";
-                    std::cout << "Name: " << emp.firstName << " " << emp.lastName << "\n";
-                    std::cout << "SSN: " << emp.ssn << "\n";
-                    std::cout << "Salary: $" << emp.salary << "\n";
-                    std::cout << "Age: " << emp.age << "\n";
-                    std::cout << "------------------------\n";
-                }
-                else {
-                    // Display only the requested field
-                    if (fieldName == "firstName") {
-                        std::cout << emp.firstName << "\n";
-                    }
-                    else if (fieldName == "lastName") {
-                        std::cout << emp.lastName << "\n";
-                    }
-                    else if (fieldName == "ssn") {
-                        std::cout << emp.ssn << "\n";
-                    }
-                    else if (fieldName == "salary") {
-                        std::cout << emp.salary << "\n";
-                    }
-                    else if (fieldName == "age") {
-                        std::cout << emp.age << "\n";
-                    }
-                }
+        }
+    };
+    if (!scanned.empty()) {
+        ScopedTimer scanTimer(metrics, Operation::FullScan);
+        ThreadPool* workers = n >= PARALLEL_MIN_RECORDS ? pool() : nullptr;
+        if (workers) {
+            workers->parallelFor(chunks, scanChunk);
+        }
+        else {
+            for (std::size_t c = 0; c < chunks; c++) {
+                scanChunk(c);
             }
         }
     }
-
-    if (!foundAny) {
-        std::cout << "No matching records found.\n";
+    for (std::size_t i = 0; i < scanned.size(); i++) {
+        SlotBuffer& slots = matches[scanned[i]];
+        for (const SlotBuffer& part : parts[i]) {
+            slots.insert(slots.end(), part.begin(), part.end());
+        }
     }
-    file.close();
-}
-
-// Processes user menu choices from the queue
-void EmployeeDB::processMenuQueue() {
-    while (!menuQueue.empty()) {           // Process all queued commands
-        int choice = menuQueue.front();    // Get next choice
-        menuQueue.pop();                   // Remove from queue
 
-        switch (choice) {
-        case 1: addEmployee();     // Add new employee
-            break;
-        case 2: displayEmployees();    // Show all employees
-            break;
-        case 3: deleteEmployee();     // Delete employee
-            break;
-        case 4: {              // Index records by field
-            std::cout << "Index by:\n1. Salary\n2. Age\n3. Last Name\n4. SSN\n";
-            int field;
-            std::cin >> field;      // Get field choice
-            std::cin.ignore();      // Clear input buffer
-            std::cout << "Sort order (0=descending, 1=ascending): ";
-            bool ascending;
-            std::cin >> ascending;     // Get sort direction
-            std::cin.ignore();
-            indexByField(field, ascending);    // Perform indexing
-            break;
+    for (std::size_t p = 0; p < plans.size(); p++) {
+        const QueryPlan& plan = plans[p];
+        if (plan.aggregates.empty()) {
+            orderAndLimit(plan, matches[p]);
+            results[p] = makeResult(std::move(matches[p]), plan.projection);
+            continue;
         }
-        case 5: searchBySSN();     // Search by SSN
-            break;
-        case 6: std::cout << "Exiting...\n"; exit(0);    // Quit program
-        default: std::cout << "Invalid choice: " << choice << "\n";    // Handle invalid input
+        HashAggregator aggregator(plan, store.data(), &arena);
+        for (std::size_t slot : matches[p]) {
+            aggregator.add(slot);          // Index-served plans
         }
+        std::size_t i = std::find(scanned.begin(), scanned.end(), p) - scanned.begin();
+        if (i < scanned.size()) {
+            for (const HashAggregator& part : groups[i]) {
+                aggregator.merge(part);
+            }
+        }
+        results[p] = makeResult({});
+        results[p].aggregated = true;
+        results[p].table = aggregator.finish();
     }
+    return results;
+}
+
+// Compiles a query containing ? placeholders for repeated execution
+std::shared_ptr<const QueryPlan> EmployeeDB::prepareQuery(const std::string& query) {
+    return std::make_shared<const QueryPlan>(compileQuery(query));
+}
+
+// Binds values to a prepared query's placeholders and runs it
+QueryResult EmployeeDB::execute(const QueryPlan& prepared, const std::vector<std::string>& params) {
+    QueryPlan plan = bindQuery(prepared, params);
+    return run(plan);
+}
+
+// Executes a bound plan: matching rows, or the groups of an aggregate query.
+// Temporaries come from a query arena that is reset when the query ends.
+QueryResult EmployeeDB::run(const QueryPlan& plan) {
+    ScopedTimer timer(metrics, Operation::Query);
+    std::shared_lock<ReadWriteLock> guard(rwLock);
+    ArenaLease lease(queryArena, arenaLock);
+    if (plan.aggregates.empty()) {
+        return makeResult(executePlan(plan, lease.arena()), plan.projection);
+    }
+    QueryResult result = makeResult({});
+    result.aggregated = true;
+    result.table = executeAggregate(plan, lease.arena());
+    return result;
 }
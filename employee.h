@@ -1,85 +1,285 @@
-#include "employee.h"  // Include the EmployeeDB class definition
-#include <iostream>
+#ifndef EMPLOYEE_H
+#define EMPLOYEE_H
+
+#include "aggregate.h"
+#include "bloom_filter.h"
+#include "bplus_tree.h"
+#include "buffer_pool.h"
+#include "column_store.h"
+#include "compact_record.h"
+#include "metrics.h"
+#include "query.h"
+#include "query_arena.h"
+#include "record_directory.h"
+#include "record_sort.h"
+#include "record.h"
+#include "record_store.h"
+#include "record_writer.h"
+#include "rw_lock.h"
+#include "secondary_index.h"
+#include "thread_pool.h"
+#include "write_ahead_log.h"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// Outcome of a bulk import
+struct ImportResult {
+    std::size_t imported = 0;        // Rows appended to the database
+    std::size_t invalid = 0;         // Rows rejected by validation
+    std::size_t duplicates = 0;      // Rows whose SSN already exists
+};
+
+// One mutation of a write batch (EmployeeDB::applyBatch)
+struct Mutation {
+    enum class Kind { Insert, Erase };
+    Kind kind = Kind::Insert;
+    Employee emp{};                  // Insert: the new employee (its id is ignored)
+    int id = 0;                      // Erase: the employee to delete
+};
+
+// Outcome of one mutation in a write batch
+struct MutationResult {
+    bool ok = false;
+    int id = 0;                      // ID assigned (Insert) or deleted (Erase)
+    std::string error;               // Why the mutation was rejected
+};
+
+// Rows returned by the EmployeeDB read API, in result order. Rows point into
+// the mapped data file, which the result keeps mapped, so they stay readable
+// while other threads modify the database (a later delete shows up only as
+// the row's isDeleted flag).
+class QueryResult {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Employee;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Employee*;
+        using reference = const Employee&;
+
+        iterator(const Employee* records, SlotBuffer::const_iterator pos)
+            : records(records), pos(pos) {}
+
+        reference operator*() const { return records[*pos]; }
+        pointer operator->() const { return &records[*pos]; }
+        iterator& operator++() { ++pos; return *this; }
+        iterator operator++(int) { iterator old = *this; ++pos; return old; }
+        bool operator==(const iterator& other) const { return pos == other.pos; }
+        bool operator!=(const iterator& other) const { return pos != other.pos; }
+
+    private:
+        const Employee* records;
+        SlotBuffer::const_iterator pos;
+    };
+
+    iterator begin() const { return iterator(records, slots.begin()); }
+    iterator end() const { return iterator(records, slots.end()); }
+    std::size_t size() const { return slots.size(); }
+    bool empty() const { return slots.empty(); }
+    const Employee& operator[](std::size_t i) const { return records[slots[i]]; }
+
+    // Fields selected by the query; empty means all of them
+    const std::vector<Field>& projection() const { return fields; }
+
+    // Aggregate queries (COUNT, SUM, AVG, MIN, MAX, GROUP BY) return no rows;
+    // their groups are in aggregates() instead
+    bool isAggregate() const { return aggregated; }
+    const AggregateTable& aggregates() const { return table; }
+
+private:
+    friend class EmployeeDB;
+    const Employee* records = nullptr;   // Base of the mapping the slots index into
+    std::shared_ptr<const void> mapping; // Keeps that mapping alive
+    SlotBuffer slots;                    // Record slots in result order
+    std::vector<Field> fields;
+    bool aggregated = false;
+    AggregateTable table;
+};
+
+// Employee database backed by a binary file of Employee records.
+// This is the engine only: it takes and returns values and never touches
+// the console (see console.h for the interactive front end).
+//
+// Thread-safe: reads (lookups, queries, sorts, exports) share a reader-writer
+// lock and run concurrently; mutations take it exclusively, one at a time.
+// A writer releases the lock before waiting for its log sync, so concurrent
+// writers share fsyncs through the log's group commit.
+class EmployeeDB {
+private:
+    const std::string filename = "employees.dat";           // Employee data file
+    const std::string ssnIndexFilename = "employees.ssn.idx";   // SSN -> record slot B+tree
+    const std::string metaFilename = "employees.meta";          // Superblock + id -> slot directory
+    const std::string walFilename = "employees.wal";            // Redo log since the last checkpoint
+    const std::string salaryIndexFilename = "employees.salary.idx";     // (salary, slot) B+tree
+    const std::string ageIndexFilename = "employees.age.idx";           // (age, slot) B+tree
+    const std::string lastNameIndexFilename = "employees.lastname.idx"; // (lastName, slot) B+tree
+    int nextId;                        // Next ID to hand out
+    mutable Metrics metrics;           // Operation latencies and event counts (lock-free)
+    RecordStore store;                 // Memory-mapped data file
+    WriteAheadLog wal;                 // Logged before the data file is written
+    std::size_t commitInterval = 1;    // Mutations per log sync (1 = each one is durable on return)
+    std::size_t uncommitted = 0;       // Logged mutations not yet synced
+    RecordDirectory directory;         // Counters and id -> slot directory
+    BufferPool indexPages;             // Page cache shared by the index files below
+    BPlusTree ssnIndex;                // Persistent index over active SSNs
+    BloomFilter ssnFilter;             // Live SSNs; lets most new SSNs skip the index
+    bool ssnFilterReady = false;       // Built on the first duplicate check
+    SecondaryIndex salaryIndex;        // Ordered indexes for range and prefix queries
+    SecondaryIndex ageIndex;
+    SecondaryIndex lastNameIndex;
+    ColumnStore columns;               // Columnar copy used by queries, built on first use
+    bool columnarScans = true;         // Use the vectorized column kernels in queries
+    StatementCache statementCache;     // Compiled plans keyed by normalized query text
+    RecordSorter sorter;               // Scratch buffers reused by sortedBy
+    SortOrderCache sortOrders;         // Orders kept by sortedBy between calls
+    bool sortOrderReuse = true;        // Serve sortedBy from sortOrders
+    QueryArena queryArena;             // Temporaries of the query running on it, freed in one step
+    std::size_t threadCount = 0;       // Threads for scans and sorts; 0 = one per hardware thread
+    std::unique_ptr<ThreadPool> threadPool;     // Created on the first parallel operation
+    double compactionThreshold = 0.5;  // Dead-row ratio that triggers automatic compaction
+    mutable ReadWriteLock rwLock;      // Shared by readers, exclusive for writers
+    std::mutex columnsLock;            // Readers bringing the column copy up to date
+    std::mutex ssnFilterLock;          // Readers building the SSN filter
+    std::mutex sorterLock;             // Owner of the shared sorter's scratch buffers
+    std::mutex arenaLock;              // Owner of the shared query arena (see ArenaLease)
+    std::mutex poolLock;               // Lazy thread pool creation
+    std::once_flag directoryLoaded;    // Lazy directory load
+
+    static const std::size_t MIN_COMPACTION_RECORDS = 1024;   // Small files are never auto-compacted
+    static const std::size_t PARALLEL_MIN_RECORDS = 1 << 17;  // Smaller files are scanned and sorted serially
+    static const std::size_t PARALLEL_SCAN_CHUNK = 1 << 16;   // Records per parallel scan task (multiple of 64)
+    static const std::uint64_t CHECKPOINT_BYTES = 8 << 20;    // Log size that triggers a checkpoint
+    static constexpr std::size_t MIN_FILTER_KEYS = 1 << 16;   // Smallest SSN filter capacity
+    static const std::size_t INDEX_SCAN_FRACTION = 8;         // Index scans give up past 1/8 of the file
+    static const std::size_t INDEX_CACHE_BYTES = 32 << 20;    // Default index page cache budget
+
+    int getNextId();
+    bool recover();
+    std::uint64_t logged(std::uint64_t lsn, std::size_t mutations);
+    void commitLog(std::uint64_t lsn);
+    void maybeCheckpoint();
+    void checkpointLocked();
+    std::size_t compactLocked();
+    ThreadPool* pool();
+    void rebuildSSNIndex();
+    void rebuildSecondaryIndexes();
+    void flushIndexes();
+    void indexRecord(const Employee& emp, std::size_t slot);
+    void unindexRecord(const Employee& emp, std::size_t slot);
+    bool scanIndexRange(const QueryPlan& plan, std::size_t budget, SlotBuffer& slots);
+    bool findLiveSlot(int id, std::size_t& slot);
+    bool eraseLocked(int id, std::uint64_t& lsn);
+    bool findSSNSlot(const char* ssn, std::size_t& slot);
+    void rebuildSSNFilter();
+    bool ssnExists(const char* ssn);
+    void noteSSN(const char* ssn);
+    void maybeCompact();
+    bool probeIndexes(const QueryPlan& plan, std::size_t cap, SlotBuffer& slots);
+    bool prepareColumns(const QueryPlan& plan);
+    void scanSlots(const QueryPlan& plan, bool columnar, std::size_t begin, std::size_t end,
+        std::size_t limit, SlotBuffer& out) const;
+    SlotBuffer executePlan(const QueryPlan& plan, QueryArena& arena);
+    void orderAndLimit(const QueryPlan& plan, SlotBuffer& slots) const;
+    AggregateTable executeAggregate(const QueryPlan& plan, QueryArena& arena);
+    QueryResult run(const QueryPlan& plan);
+    QueryResult makeResult(SlotBuffer slots, std::vector<Field> fields = {}) const;
+    void stageImport(Employee& emp, ImportResult& result, std::unordered_set<std::uint32_t>& seen,
+        std::vector<Employee>& batch);
+    void appendBatch(std::vector<Employee>& batch);
+    void indexAppended(std::size_t firstSlot);
+
+public:
+    EmployeeDB();
+    ~EmployeeDB();              // Checkpoints, so a clean shutdown leaves nothing to replay
+
+    // Mutations. Invalid input throws std::invalid_argument.
+    int insert(const Employee& emp);    // Ignores emp.id and returns the ID assigned
+    bool erase(int id);                 // False if no active employee has this ID
+
+    // Applies a group of mutations under one exclusive lock with a single log
+    // sync at the end; runs of inserts are logged and appended as one batch.
+    // Rejected mutations (invalid or duplicate SSN, unknown ID) are reported
+    // in their result and do not stop the rest.
+    std::vector<MutationResult> applyBatch(const std::vector<Mutation>& mutations);
+
+    // Point lookups over active employees
+    std::optional<Employee> findById(int id);
+    std::optional<Employee> findBySSN(std::string_view ssn);
+
+    // Active employees in file order, or sorted by a field
+    // (1=Salary, 2=Age, 3=LastName, 4=SSN; ties keep file order)
+    QueryResult employees();
+    QueryResult sortedBy(int field, bool ascending);
+    // Off: every sortedBy sorts all records and no orders are kept (for
+    // timing cold sorts); turning it off drops the kept orders
+    void setSortOrderReuse(bool enabled);
+
+    // SQL-like queries, including aggregates with GROUP BY; a malformed
+    // query throws std::invalid_argument
+    QueryResult query(const std::string& text);
+    QueryPlan planQuery(const std::string& text);      // Compiles (or reuses) and binds a query
+    // Runs several plans with one shared scan of the file for those no index answers
+    std::vector<QueryResult> queryBatch(const std::vector<QueryPlan>& plans);
+    void setColumnarScans(bool enabled);
+    // Threads used by large scans and sorts: 0 = one per hardware thread, 1 = serial
+    void setThreadCount(std::size_t threads);
+
+    // Prepared statements: compile once with ? placeholders, bind per run
+    std::shared_ptr<const QueryPlan> prepareQuery(const std::string& query);
+    QueryResult execute(const QueryPlan& prepared, const std::vector<std::string>& params);
+    void setStatementCacheSize(std::size_t entries) { statementCache.setCapacity(entries); }
+
+    // Bulk loading and dumping (bulk_io.cpp). Imports assign fresh IDs and
+    // skip invalid rows and SSNs that already exist. An import that throws
+    // partway (a malformed compact file, an I/O error) keeps the rows it
+    // had already appended, fully indexed.
+    ImportResult importCSV(const std::string& path);
+    ImportResult importBinary(const std::string& path);
+    ImportResult importCompact(const std::string& path);     // Compact record format (compact_record.h)
+    std::size_t exportCSV(const std::string& path);
+    std::size_t exportBinary(const std::string& path);
+    std::size_t exportJSONLines(const std::string& path);     // One JSON object per line
+    std::size_t exportCompact(const std::string& path);
+    std::size_t exportRows(const std::string& path, OutputFormat format);
+
+    // Drops deleted records from the data file and rebuilds the indexes;
+    // returns how many records were removed
+    std::size_t compact();
+    // Dead-row ratio (0..1) above which deletes trigger compaction; 0 disables it
+    void setCompactionThreshold(double ratio);
+    // Memory budget of the page cache shared by the index files; lookups
+    // and index scans over a working set that fits are served from memory
+    void setIndexCacheSize(std::size_t bytes);
+
+    // Durability. Every mutation is logged before the data file is written;
+    // the log is synced once per commit interval (group commit), by sync(),
+    // and by each checkpoint, which also syncs the data file and empties it.
+    // Mutations since the last log sync can be lost on power failure.
+    void setCommitInterval(std::size_t mutations);
+    void sync();
+    void checkpoint();
+
+    std::size_t recordCount() const;    // Records in the file, deleted included
+    std::size_t liveCount() const;
+
+    // Instrumentation: latency histograms per operation (and per phase of
+    // an operation), event counts and per-file I/O since open or the last
+    // resetStats(). With tracing on, each timed operation also leaves a
+    // span in a bounded buffer.
+    MetricsSnapshot stats() const;
+    void resetStats() { metrics.reset(); }
+    void setTracing(bool enabled) { metrics.setTracing(enabled); }
+    std::vector<TraceSpan> traceSpans() { return metrics.traceSpans(); }
+};
 
-int main() {
-    // Create an instance of the Employee Database
-    EmployeeDB db;
-
-    // String to store user input
-    std::string input;
-
-    // Main program loop - runs until user chooses to exit
-    while (true) {
-        // Display the menu options
-        std::cout << "\nEmployee Database System\n";
-        std::cout << "1. Add Employee\n";
-        std::cout << "2. Display Employees\n";
-        std::cout << "3. Delete Employee\n";
-        std::cout << "4. Index Records\n";
-        std::cout << "5. Search by SSN\n";
-        std::cout << "6. Run Query\n";
-        std::cout << "7. Exit\n";
-        std::cout << "Enter choice: ";
-
-        // Get user input (whole line to avoid parsing issues)
-        std::getline(std::cin, input);
-
-        // Try-catch block to handle any exceptions
-        try {
-            // Process user choice
-            if (input == "1") {
-                // Add a new employee
-                db.addEmployee();
-            }
-            else if (input == "2") {
-                // Display all employees
-                db.displayEmployees();
-            }
-            else if (input == "3") {
-                // Delete an employee by ID
-                db.deleteEmployee();
-            }
-            else if (input == "4") {
-                // Index records by a specific field
-                std::cout << "Field to index (1=Salary, 2=Age, 3=LastName, 4=SSN): ";
-                int field;
-                std::cin >> field;  // Get field choice
-                std::cin.ignore();  // Clear input buffer
-
-                std::cout << "Sort order (0=Descending, 1=Ascending): ";
-                bool ascending;
-                std::cin >> ascending;  // Get sort direction
-                std::cin.ignore();     // Clear input buffer
-
-                // Perform the indexing
-                db.indexByField(field, ascending);
-            }
-            else if (input == "5") {
-                // Search for employee by SSN
-                db.searchBySSN();
-            }
-            else if (input == "6") {
-                // Execute a SQL-like query
-                std::cout << "Enter query: ";
-                std::string query;
-                std::getline(std::cin, query);  // Get full query line
-                db.runQuery(query);             // Execute the query
-            }
-            else if (input == "7") {
-                // Exit the program
-                break;
-            }
-            else {
-                // Handle invalid menu choices
-                std::cout << "Invalid choice!\n";
-            }
-        }
-        catch (const std::exception& e) {
-            // Catch and display any errors that occur
-            std::cerr << "Error: " << e.what() << "\n";
-        }
-    }
-
-    return 0;  // Successful program termination
-}
+#endif
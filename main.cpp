@@ -1,10 +1,110 @@
+#include "console.h"   // Interactive front end over the EmployeeDB engine
 #include "employee.h"  // Include the EmployeeDB class definition
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Optional format for listed rows: --format text|csv|jsonl|binary
+    // Batch mode runs a command script (or standard input) instead of the menu: --batch [file]
+    // On exit, --stats writes the engine's metrics as JSON and --trace the
+    // spans of every timed operation as JSON lines
+    // --cache-mb sets the memory budget of the index page cache
+    OutputFormat format = OutputFormat::Text;
+    bool batch = false;
+    std::string scriptPath = "-";
+    std::string statsPath;
+    std::string tracePath;
+    std::size_t cacheMB = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        try {
+            if (arg == "--format" && i + 1 < argc) {
+                format = parseOutputFormat(argv[++i]);
+            }
+            else if (arg == "--stats" && i + 1 < argc) {
+                statsPath = argv[++i];
+            }
+            else if (arg == "--trace" && i + 1 < argc) {
+                tracePath = argv[++i];
+            }
+            else if (arg == "--cache-mb" && i + 1 < argc) {
+                std::string value = argv[++i];
+                if (value.empty() || value.size() > 7 || value.find_first_not_of("0123456789") != std::string::npos
+                    || std::stoul(value) == 0) {
+                    throw std::invalid_argument("Invalid cache size '" + value + "'");
+                }
+                cacheMB = std::stoul(value);
+            }
+            else if (arg == "--batch") {
+                batch = true;
+                if (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) {
+                    scriptPath = argv[++i];
+                }
+            }
+            else {
+                throw std::invalid_argument("Unknown option '" + arg +
+                    "' (usage: employeedb [--format text|csv|jsonl|binary] [--batch [file]] [--stats file] [--trace file] [--cache-mb n])");
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
     // Create an instance of the Employee Database
     EmployeeDB db;
+    Console console(db);
+    console.setOutputFormat(format);
+    db.setTracing(!tracePath.empty());
+    if (cacheMB != 0) {
+        db.setIndexCacheSize(cacheMB << 20);
+    }
+
+    // Writes the requested metrics and trace files; false if one failed
+    auto writeDiagnostics = [&]() {
+        bool ok = true;
+        if (!statsPath.empty()) {
+            std::ofstream out(statsPath, std::ios::trunc);
+            writeStatsJSON(db.stats(), out);
+            if (!out) {
+                std::cerr << "Error: Cannot write " << statsPath << "\n";
+                ok = false;
+            }
+        }
+        if (!tracePath.empty()) {
+            std::ofstream out(tracePath, std::ios::trunc);
+            writeTraceJSON(db.traceSpans(), out);
+            if (!out) {
+                std::cerr << "Error: Cannot write " << tracePath << "\n";
+                ok = false;
+            }
+        }
+        return ok;
+    };
+
+    if (batch) {
+        std::ifstream file;
+        if (scriptPath != "-") {
+            file.open(scriptPath);
+            if (!file) {
+                std::cerr << "Error: Cannot open " << scriptPath << "\n";
+                return 1;
+            }
+        }
+        int status = 0;
+        try {
+            std::size_t failures = console.runScript(scriptPath == "-" ? std::cin : file);
+            status = failures == 0 ? 0 : 1;
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            status = 1;
+        }
+        return writeDiagnostics() ? status : 1;
+    }
 
     // String to store user input
     std::string input;
@@ -20,25 +120,32 @@ int main() {
         std::cout << "5. Search by SSN\n";
         std::cout << "6. Run Query\n";
         std::cout << "7. Exit\n";
+        std::cout << "8. Compact Database\n";
+        std::cout << "9. Display Employee by ID\n";
+        std::cout << "10. Import Employees\n";
+        std::cout << "11. Export Employees\n";
+        std::cout << "12. Show Statistics\n";
         std::cout << "Enter choice: ";
 
-        // Get user input (whole line to avoid parsing issues)
-        std::getline(std::cin, input);
+        // Get user input (whole line to avoid parsing issues); stop at end of input
+        if (!std::getline(std::cin, input)) {
+            break;
+        }
 
         // Try-catch block to handle any exceptions
         try {
             // Process user choice
             if (input == "1") {
                 // Add a new employee
-                db.addEmployee();
+                console.addEmployee();
             }
             else if (input == "2") {
                 // Display all employees
-                db.displayEmployees();
+                console.displayEmployees();
             }
             else if (input == "3") {
                 // Delete an employee by ID
-                db.deleteEmployee();
+                console.deleteEmployee();
             }
             else if (input == "4") {
                 // Index records by a specific field
@@ -53,23 +160,43 @@ int main() {
                 std::cin.ignore();     // Clear input buffer
 
                 // Perform the indexing
-                db.indexByField(field, ascending);
+                console.indexByField(field, ascending);
             }
             else if (input == "5") {
                 // Search for employee by SSN
-                db.searchBySSN();
+                console.searchBySSN();
             }
             else if (input == "6") {
                 // Execute a SQL-like query
                 std::cout << "Enter query: ";
                 std::string query;
                 std::getline(std::cin, query);  // Get full query line
-                db.runQuery(query);             // Execute the query
+                console.runQuery(query);             // Execute the query
             }
             else if (input == "7") {
                 // Exit the program
                 break;
             }
+            else if (input == "8") {
+                // Reclaim space used by deleted records
+                console.compact();
+            }
+            else if (input == "9") {
+                // Look up a single employee by ID
+                console.displayEmployeeById();
+            }
+            else if (input == "10") {
+                // Bulk load employees from a CSV or binary file
+                console.importEmployees();
+            }
+            else if (input == "11") {
+                // Dump all active employees to a CSV or binary file
+                console.exportEmployees();
+            }
+            else if (input == "12") {
+                // Operation latencies, event counts and file I/O since startup
+                console.showStats();
+            }
             else {
                 // Handle invalid menu choices
                 std::cout << "Invalid choice!\n";
@@ -81,5 +208,5 @@ int main() {
         }
     }
 
-    return 0;  // Successful program termination
+    return writeDiagnostics() ? 0 : 1;  // Successful program termination unless a dump failed
 }
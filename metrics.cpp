@@ -0,0 +1,298 @@
+#include "metrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+namespace {
+    const char* const OPERATION_NAMES[] = {
+        "insert", "erase", "apply_batch", "find_by_id", "find_by_ssn", "employees", "sorted_by",
+        "query", "query_batch", "import", "export", "compact", "checkpoint",
+        "duplicate_check", "log_sync", "index_scan", "full_scan", "order"
+    };
+    static_assert(sizeof(OPERATION_NAMES) / sizeof(OPERATION_NAMES[0]) == static_cast<std::size_t>(Operation::Count),
+        "every operation needs a name");
+
+    const char* const EVENT_NAMES[] = {
+        "records_scanned", "tombstones_skipped", "bytes_scanned", "index_probes",
+        "index_range_scans", "index_fallbacks", "filter_rejects", "rows_returned",
+        "sorts_reused"
+    };
+    static_assert(sizeof(EVENT_NAMES) / sizeof(EVENT_NAMES[0]) == static_cast<std::size_t>(Event::Count),
+        "every event needs a name");
+
+    const double PERCENTILES[] = { 0.5, 0.9, 0.99, 0.999 };
+    const char* const PERCENTILE_NAMES[] = { "p50", "p90", "p99", "p999" };
+
+    // Small sequential thread numbers read better in traces than native ids
+    std::uint32_t threadNumber() {
+        static std::atomic<std::uint32_t> next{0};
+        thread_local std::uint32_t number = next.fetch_add(1, std::memory_order_relaxed);
+        return number;
+    }
+
+    // 812ns, 15.2us, 3.41ms, 1.20s
+    std::string formatNanos(double nanos) {
+        char text[32];
+        if (nanos < 1000.0) {
+            std::snprintf(text, sizeof(text), "%.0fns", nanos);
+        }
+        else if (nanos < 1e6) {
+            std::snprintf(text, sizeof(text), "%.1fus", nanos / 1e3);
+        }
+        else if (nanos < 1e9) {
+            std::snprintf(text, sizeof(text), "%.2fms", nanos / 1e6);
+        }
+        else {
+            std::snprintf(text, sizeof(text), "%.2fs", nanos / 1e9);
+        }
+        return text;
+    }
+
+    void writeIOText(const char* name, const IOStats& io, std::ostream& out) {
+        out << name << ": " << io.reads << " reads (" << io.bytesRead << " bytes), "
+            << io.writes << " writes (" << io.bytesWritten << " bytes), " << io.syncs << " syncs\n";
+    }
+
+    void writeIOJSON(const char* name, const IOStats& io, std::ostream& out) {
+        out << '"' << name << "\":{\"reads\":" << io.reads << ",\"bytes_read\":" << io.bytesRead
+            << ",\"writes\":" << io.writes << ",\"bytes_written\":" << io.bytesWritten
+            << ",\"syncs\":" << io.syncs << '}';
+    }
+}
+
+const char* operationName(Operation op) {
+    return OPERATION_NAMES[static_cast<std::size_t>(op)];
+}
+
+const char* eventName(Event event) {
+    return EVENT_NAMES[static_cast<std::size_t>(event)];
+}
+
+IOStats& IOStats::operator+=(const IOStats& other) {
+    reads += other.reads;
+    bytesRead += other.bytesRead;
+    writes += other.writes;
+    bytesWritten += other.bytesWritten;
+    syncs += other.syncs;
+    return *this;
+}
+
+IOStats IOCounters::snapshot() const {
+    IOStats stats;
+    stats.reads = reads.load();
+    stats.bytesRead = bytesRead.load();
+    stats.writes = writes.load();
+    stats.bytesWritten = bytesWritten.load();
+    stats.syncs = syncs.load();
+    return stats;
+}
+
+double HistogramSnapshot::meanNanos() const {
+    return count ? static_cast<double>(totalNanos) / static_cast<double>(count) : 0.0;
+}
+
+std::uint64_t HistogramSnapshot::percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(q * static_cast<double>(count) + 0.5));
+    std::uint64_t seen = 0;
+    for (std::size_t bucket = 0; bucket < buckets.size(); bucket++) {
+        seen += buckets[bucket];
+        if (seen >= rank) {
+            return std::min(LatencyHistogram::bucketHigh(bucket), maxNanos);
+        }
+    }
+    return maxNanos;
+}
+
+// Values below 16 get a bucket each; above that, the top bit picks the
+// power of two and the next four bits the sub-bucket within it
+std::size_t LatencyHistogram::bucketOf(std::uint64_t nanos) {
+    if (nanos < SUB_BUCKETS) {
+        return static_cast<std::size_t>(nanos);
+    }
+    unsigned top = 63u - static_cast<unsigned>(__builtin_clzll(nanos));
+    if (top >= MAX_BITS) {
+        return BUCKETS - 1;
+    }
+    unsigned shift = top - SUB_BUCKET_BITS;
+    return (top - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + static_cast<std::size_t>((nanos >> shift) - SUB_BUCKETS);
+}
+
+std::uint64_t LatencyHistogram::bucketHigh(std::size_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    unsigned shift = static_cast<unsigned>(bucket / SUB_BUCKETS) - 1;
+    std::uint64_t low = (SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+    return low + (std::uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::uint64_t nanos) {
+    buckets[bucketOf(nanos)].add();
+    totalNanos.add(nanos);
+    std::uint64_t seen = maxNanos.load(std::memory_order_relaxed);
+    while (nanos > seen && !maxNanos.compare_exchange_weak(seen, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+HistogramSnapshot LatencyHistogram::snapshot() const {
+    HistogramSnapshot copy;
+    copy.totalNanos = totalNanos.load();
+    copy.maxNanos = maxNanos.load(std::memory_order_relaxed);
+    copy.buckets.resize(BUCKETS);
+    for (std::size_t bucket = 0; bucket < BUCKETS; bucket++) {
+        copy.buckets[bucket] = buckets[bucket].load();
+        copy.count += copy.buckets[bucket];
+    }
+    return copy;
+}
+
+void LatencyHistogram::reset() {
+    for (Counter& bucket : buckets) {
+        bucket.reset();
+    }
+    totalNanos.reset();
+    maxNanos.store(0, std::memory_order_relaxed);
+}
+
+Metrics::Metrics() : epoch(now()) {}
+
+std::uint64_t Metrics::now() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Metrics::finish(Operation op, std::uint64_t startNanos) {
+    std::uint64_t end = now();
+    std::uint64_t duration = end - startNanos;
+    latencies[static_cast<std::size_t>(op)].record(duration);
+    if (!tracing()) {
+        return;
+    }
+    TraceSpan span{ op, threadNumber(), startNanos - epoch, duration };
+    std::lock_guard<std::mutex> guard(traceLock);
+    if (spans.size() < TRACE_CAPACITY) {
+        spans.push_back(span);
+    }
+    else {
+        spans[nextSpan] = span;         // Full: overwrite the oldest
+    }
+    nextSpan = (nextSpan + 1) % TRACE_CAPACITY;
+}
+
+// Turning tracing on starts a fresh trace
+void Metrics::setTracing(bool enabled) {
+    std::lock_guard<std::mutex> guard(traceLock);
+    if (enabled && !tracing()) {
+        spans.clear();
+        nextSpan = 0;
+    }
+    tracingOn.store(enabled, std::memory_order_relaxed);
+}
+
+std::vector<TraceSpan> Metrics::traceSpans() {
+    std::lock_guard<std::mutex> guard(traceLock);
+    if (spans.size() < TRACE_CAPACITY) {
+        return spans;
+    }
+    std::vector<TraceSpan> ordered(spans.begin() + static_cast<std::ptrdiff_t>(nextSpan), spans.end());
+    ordered.insert(ordered.end(), spans.begin(), spans.begin() + static_cast<std::ptrdiff_t>(nextSpan));
+    return ordered;
+}
+
+MetricsSnapshot Metrics::snapshot() const {
+    MetricsSnapshot stats;
+    stats.uptimeSeconds = static_cast<double>(now() - epoch) / 1e9;
+    for (const LatencyHistogram& latency : latencies) {
+        stats.operations.push_back(latency.snapshot());
+    }
+    for (const Counter& event : events) {
+        stats.events.push_back(event.load());
+    }
+    return stats;
+}
+
+void Metrics::reset() {
+    for (LatencyHistogram& latency : latencies) {
+        latency.reset();
+    }
+    for (Counter& event : events) {
+        event.reset();
+    }
+}
+
+void writeStatsText(const MetricsSnapshot& stats, std::ostream& out) {
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-16s %10s %10s %10s %10s %10s %10s\n",
+        "operation", "count", "mean", "p50", "p99", "p999", "max");
+    out << line;
+    for (std::size_t op = 0; op < stats.operations.size(); op++) {
+        const HistogramSnapshot& latency = stats.operations[op];
+        if (latency.count == 0) {
+            continue;
+        }
+        std::snprintf(line, sizeof(line), "%-16s %10llu %10s %10s %10s %10s %10s\n",
+            operationName(static_cast<Operation>(op)), static_cast<unsigned long long>(latency.count),
+            formatNanos(latency.meanNanos()).c_str(),
+            formatNanos(static_cast<double>(latency.percentile(0.5))).c_str(),
+            formatNanos(static_cast<double>(latency.percentile(0.99))).c_str(),
+            formatNanos(static_cast<double>(latency.percentile(0.999))).c_str(),
+            formatNanos(static_cast<double>(latency.maxNanos)).c_str());
+        out << line;
+    }
+    out << '\n';
+    for (std::size_t event = 0; event < stats.events.size(); event++) {
+        out << eventName(static_cast<Event>(event)) << ": " << stats.events[event] << '\n';
+    }
+    out << '\n';
+    writeIOText("data file", stats.dataFile, out);
+    writeIOText("log", stats.log, out);
+    writeIOText("indexes", stats.indexes, out);
+    const CacheStats& cache = stats.indexCache;
+    std::uint64_t lookups = cache.hits + cache.misses;
+    out << "index cache: " << cache.hits << " hits, " << cache.misses << " misses ("
+        << (lookups ? cache.hits * 100 / lookups : 0) << "% hits), " << cache.evictions << " evictions, "
+        << cache.writeBacks << " write-backs, " << cache.pages << " of " << cache.capacityPages << " pages\n";
+}
+
+void writeStatsJSON(const MetricsSnapshot& stats, std::ostream& out) {
+    out << "{\"uptime_seconds\":" << stats.uptimeSeconds << ",\"operations\":{";
+    bool first = true;
+    for (std::size_t op = 0; op < stats.operations.size(); op++) {
+        const HistogramSnapshot& latency = stats.operations[op];
+        if (latency.count == 0) {
+            continue;
+        }
+        out << (first ? "" : ",") << '"' << operationName(static_cast<Operation>(op)) << "\":{\"count\":"
+            << latency.count << ",\"total_ns\":" << latency.totalNanos
+            << ",\"mean_ns\":" << static_cast<std::uint64_t>(latency.meanNanos() + 0.5);
+        for (std::size_t p = 0; p < sizeof(PERCENTILES) / sizeof(PERCENTILES[0]); p++) {
+            out << ",\"" << PERCENTILE_NAMES[p] << "_ns\":" << latency.percentile(PERCENTILES[p]);
+        }
+        out << ",\"max_ns\":" << latency.maxNanos << '}';
+        first = false;
+    }
+    out << "},\"events\":{";
+    for (std::size_t event = 0; event < stats.events.size(); event++) {
+        out << (event ? "," : "") << '"' << eventName(static_cast<Event>(event)) << "\":" << stats.events[event];
+    }
+    out << "},\"io\":{";
+    writeIOJSON("data_file", stats.dataFile, out);
+    out << ',';
+    writeIOJSON("log", stats.log, out);
+    out << ',';
+    writeIOJSON("indexes", stats.indexes, out);
+    const CacheStats& cache = stats.indexCache;
+    out << "},\"index_cache\":{\"hits\":" << cache.hits << ",\"misses\":" << cache.misses
+        << ",\"evictions\":" << cache.evictions << ",\"write_backs\":" << cache.writeBacks
+        << ",\"pages\":" << cache.pages << ",\"capacity_pages\":" << cache.capacityPages << "}}\n";
+}
+
+void writeTraceJSON(const std::vector<TraceSpan>& spans, std::ostream& out) {
+    for (const TraceSpan& span : spans) {
+        out << "{\"op\":\"" << operationName(span.op) << "\",\"thread\":" << span.thread
+            << ",\"start_ns\":" << span.startNanos << ",\"duration_ns\":" << span.durationNanos << "}\n";
+    }
+}
@@ -0,0 +1,214 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// Timed EmployeeDB operations: the public calls first, then the phases
+// inside them (each phase is also counted within its call's latency)
+enum class Operation {
+    Insert,
+    Erase,
+    ApplyBatch,
+    FindById,
+    FindBySSN,
+    Employees,
+    SortedBy,
+    Query,
+    QueryBatch,
+    Import,
+    Export,
+    Compact,
+    Checkpoint,
+    DuplicateCheck,     // SSN uniqueness check of an insert
+    LogSync,            // Waiting for the write-ahead log to reach disk
+    IndexScan,          // Query rows collected through an index
+    FullScan,           // Query rows collected by scanning the whole file
+    Order,              // ORDER BY and LIMIT over the matching rows
+    Count
+};
+
+// Counted engine events
+enum class Event {
+    RecordsScanned,     // Rows examined by full scans
+    TombstonesSkipped,  // Deleted rows passed over by full scans
+    BytesScanned,       // Record bytes read from the mapped data file by row scans
+    IndexProbes,        // Point lookups in the SSN B+tree
+    IndexRangeScans,    // Query ranges answered by an ordered index
+    IndexFallbacks,     // Index ranges too wide to pay off, rescanned in full
+    FilterRejects,      // SSN lookups settled by the Bloom filter alone
+    RowsReturned,       // Rows handed back in query results
+    SortsReused,        // Sorts that spliced new records into a kept order
+    Count
+};
+
+const char* operationName(Operation op);       // e.g. "find_by_ssn"
+const char* eventName(Event event);            // e.g. "records_scanned"
+
+// Lock-free event counter. Increments are relaxed: readers only need
+// totals, not ordering with the work being counted.
+class Counter {
+public:
+    void add(std::uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    std::uint64_t load() const { return value.load(std::memory_order_relaxed); }
+    void reset() { value.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::uint64_t> value{0};
+};
+
+// Totals of one file's system calls
+struct IOStats {
+    std::uint64_t reads = 0;            // Positioned reads (each one a seek)
+    std::uint64_t bytesRead = 0;
+    std::uint64_t writes = 0;           // Positioned writes
+    std::uint64_t bytesWritten = 0;
+    std::uint64_t syncs = 0;            // fsync / fdatasync
+
+    IOStats& operator+=(const IOStats& other);
+};
+
+// I/O counters kept by each file-backed component
+struct IOCounters {
+    Counter reads;
+    Counter bytesRead;
+    Counter writes;
+    Counter bytesWritten;
+    Counter syncs;
+
+    void read(std::size_t bytes) { reads.add(); bytesRead.add(bytes); }
+    void wrote(std::size_t bytes) { writes.add(); bytesWritten.add(bytes); }
+    void synced() { syncs.add(); }
+    IOStats snapshot() const;
+};
+
+// Hit and eviction totals of a page cache (see buffer_pool.h)
+struct CacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;           // Pages read from their file
+    std::uint64_t evictions = 0;
+    std::uint64_t writeBacks = 0;       // Dirty pages written to their file
+    std::size_t pages = 0;              // Pages cached now
+    std::size_t capacityPages = 0;
+};
+
+// Copy of a latency histogram taken at one point in time
+struct HistogramSnapshot {
+    std::uint64_t count = 0;
+    std::uint64_t totalNanos = 0;
+    std::uint64_t maxNanos = 0;
+    std::vector<std::uint64_t> buckets;
+
+    double meanNanos() const;
+    // Upper bound of the bucket holding the q-th (0..1) fastest sample,
+    // capped at the maximum; 0 without samples
+    std::uint64_t percentile(double q) const;
+};
+
+// Latency histogram in the style of HdrHistogram: every power of two of
+// nanoseconds is split into 16 linear sub-buckets, so a percentile is off
+// by at most 1/16 of its value while 1ns to 18 minutes fits in under 600
+// counters. Recording takes two relaxed atomic adds (bucket and total) and
+// no lock; the sample count is the sum of the buckets.
+class LatencyHistogram {
+public:
+    static const unsigned SUB_BUCKET_BITS = 4;
+    static const unsigned SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static const unsigned MAX_BITS = 40;       // Values of 2^40 ns and more share the last bucket
+    static const std::size_t BUCKETS = (MAX_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    void record(std::uint64_t nanos);
+    HistogramSnapshot snapshot() const;
+    void reset();
+
+    static std::size_t bucketOf(std::uint64_t nanos);
+    static std::uint64_t bucketHigh(std::size_t bucket);   // Largest value in the bucket
+
+private:
+    std::array<Counter, BUCKETS> buckets;
+    Counter totalNanos;
+    std::atomic<std::uint64_t> maxNanos{0};
+};
+
+// One timed operation, as recorded while tracing is on
+struct TraceSpan {
+    Operation op;
+    std::uint32_t thread;           // Small per-thread number, in order of first use
+    std::uint64_t startNanos;       // Since the Metrics object was created
+    std::uint64_t durationNanos;
+};
+
+// Everything Metrics knows, copied out at one point in time
+struct MetricsSnapshot {
+    double uptimeSeconds = 0.0;
+    std::vector<HistogramSnapshot> operations;     // Indexed by Operation
+    std::vector<std::uint64_t> events;             // Indexed by Event
+    IOStats dataFile;
+    IOStats log;
+    IOStats indexes;                               // SSN and secondary index files
+    CacheStats indexCache;                         // Page cache in front of the index files
+};
+
+// Operation latencies and event counts of one EmployeeDB. Updates are
+// lock-free, so it is safe to record from concurrent readers; with tracing
+// on, every timed operation also leaves a span in a bounded buffer (the
+// oldest spans are dropped once it is full).
+class Metrics {
+public:
+    static const std::size_t TRACE_CAPACITY = 1 << 16;
+
+    Metrics();
+
+    static std::uint64_t now();                         // Steady clock, nanoseconds
+
+    void count(Event event, std::uint64_t n = 1) { events[static_cast<std::size_t>(event)].add(n); }
+    void finish(Operation op, std::uint64_t startNanos);    // Records one operation that began at startNanos
+
+    void setTracing(bool enabled);
+    bool tracing() const { return tracingOn.load(std::memory_order_relaxed); }
+    std::vector<TraceSpan> traceSpans();                // Buffered spans, oldest first
+
+    // Operations and events only; the caller fills in the I/O totals
+    MetricsSnapshot snapshot() const;
+    void reset();
+
+private:
+    std::uint64_t epoch;
+    std::array<LatencyHistogram, static_cast<std::size_t>(Operation::Count)> latencies;
+    std::array<Counter, static_cast<std::size_t>(Event::Count)> events;
+    std::atomic<bool> tracingOn{false};
+    std::mutex traceLock;                   // Guards the span ring
+    std::vector<TraceSpan> spans;
+    std::size_t nextSpan = 0;               // Ring position of the next span
+};
+
+// Times the enclosing scope as one operation
+class ScopedTimer {
+public:
+    ScopedTimer(Metrics& metrics, Operation op) : metrics(metrics), op(op), start(Metrics::now()) {}
+    ~ScopedTimer() { metrics.finish(op, start); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Metrics& metrics;
+    Operation op;
+    std::uint64_t start;
+};
+
+// Human-readable report: a latency table of the operations seen so far,
+// then the event counts and per-file I/O
+void writeStatsText(const MetricsSnapshot& stats, std::ostream& out);
+// The same as one JSON object, for scripts and dashboards
+void writeStatsJSON(const MetricsSnapshot& stats, std::ostream& out);
+// One JSON object per span: {"op":...,"thread":...,"start_ns":...,"duration_ns":...}
+void writeTraceJSON(const std::vector<TraceSpan>& spans, std::ostream& out);
+
+#endif
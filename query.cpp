@@ -0,0 +1,861 @@
+#include "query.h"
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    // Case-insensitive comparison used for keywords and field names
+    bool equalsIgnoreCase(const std::string& a, const char* b) {
+        std::size_t n = std::strlen(b);
+        if (a.size() != n) {
+            return false;
+        }
+        for (std::size_t i = 0; i < n; i++) {
+            if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const char* textOf(const Employee& emp, Field field) {
+        switch (field) {
+        case Field::FirstName: return emp.firstName;
+        case Field::LastName: return emp.lastName;
+        default: return emp.ssn;
+        }
+    }
+
+    // Applies a comparison operator to the result of a three-way compare
+    bool applyOp(CompareOp op, int cmp) {
+        switch (op) {
+        case CompareOp::EQ: return cmp == 0;
+        case CompareOp::NE: return cmp != 0;
+        case CompareOp::LT: return cmp < 0;
+        case CompareOp::LE: return cmp <= 0;
+        case CompareOp::GT: return cmp > 0;
+        case CompareOp::GE: return cmp >= 0;
+        case CompareOp::PREFIX: return cmp == 0;
+        }
+        return false;
+    }
+
+    // Three-way text compare; PREFIX only compares the pattern's length
+    int compareText(CompareOp op, const char* text, const std::string& value) {
+        if (op == CompareOp::PREFIX) {
+            return std::strncmp(text, value.c_str(), value.size());
+        }
+        return std::strcmp(text, value.c_str());
+    }
+
+    // Turns a LIKE pattern into a prefix match. Only a trailing % is
+    // supported; a pattern without % is a plain equality.
+    void applyLikePattern(Predicate& leaf) {
+        std::string& pattern = leaf.value.text;
+        std::size_t percent = pattern.find('%');
+        if (pattern.find('_') != std::string::npos ||
+            (percent != std::string::npos && percent + 1 != pattern.size())) {
+            throw std::invalid_argument("LIKE supports only a trailing % (prefix match)");
+        }
+        if (percent == std::string::npos) {
+            leaf.op = CompareOp::EQ;
+        }
+        else {
+            pattern.pop_back();
+        }
+    }
+
+    template <typename T>
+    int threeWay(T a, T b) {
+        return (a < b) ? -1 : (b < a) ? 1 : 0;
+    }
+
+    long long parseInt(const std::string& text) {
+        std::size_t used = 0;
+        long long value = 0;
+        try {
+            value = std::stoll(text, &used);
+        }
+        catch (const std::exception&) {
+            used = 0;
+        }
+        if (used != text.size() || text.empty()) {
+            throw std::invalid_argument("Invalid integer '" + text + "'");
+        }
+        return value;
+    }
+
+    float parseFloat(const std::string& text) {
+        std::size_t used = 0;
+        float value = 0.0f;
+        try {
+            value = std::stof(text, &used);
+        }
+        catch (const std::exception&) {
+            used = 0;
+        }
+        if (used != text.size() || text.empty()) {
+            throw std::invalid_argument("Invalid number '" + text + "'");
+        }
+        return value;
+    }
+
+    // Converts literal text to the type of the field it is compared against
+    void convertLiteral(Field field, const std::string& text, TypedValue& value) {
+        switch (field) {
+        case Field::Id:
+        case Field::Age:
+            value.intValue = static_cast<int>(parseInt(text));
+            break;
+        case Field::Salary:
+            value.floatValue = parseFloat(text);
+            break;
+        default:
+            value.text = text;        // Names and SSNs compare as text
+            break;
+        }
+    }
+
+    // Recursive-descent parser producing a QueryPlan
+    class Parser {
+    public:
+        explicit Parser(std::vector<Token> tokens) : tokens(std::move(tokens)) {}
+
+        QueryPlan parse() {
+            QueryPlan plan;
+            expectKeyword("SELECT");
+
+            // Projection: *, or a comma-separated list of fields and aggregates
+            std::vector<Field> plainFields;
+            if (!acceptSymbol("*")) {
+                do {
+                    AggregateColumn column;
+                    if (parseAggregate(column)) {
+                        plan.aggregates.push_back(column);
+                    }
+                    else {
+                        column.op = AggregateOp::Key;
+                        column.field = parseField();
+                        plan.projection.push_back(column.field);
+                        plan.aggregates.push_back(column);
+                    }
+                } while (acceptSymbol(","));
+            }
+
+            // FROM is optional and the table name may be omitted
+            if (acceptKeyword("FROM")) {
+                if (peek().type == TokenType::Identifier && !isKeyword(peek())) {
+                    next();
+                }
+            }
+
+            if (acceptKeyword("WHERE")) {
+                plan.hasFilter = true;
+                plan.filter = parseOr();
+            }
+
+            if (acceptKeyword("GROUP")) {
+                expectKeyword("BY");
+                plan.grouped = true;
+                plan.groupBy = parseField();
+            }
+
+            if (acceptKeyword("ORDER")) {
+                expectKeyword("BY");
+                do {
+                    SortKey key{ parseField(), true };
+                    if (acceptKeyword("DESC")) {
+                        key.ascending = false;
+                    }
+                    else {
+                        acceptKeyword("ASC");
+                    }
+                    plan.orderBy.push_back(key);
+                } while (acceptSymbol(","));
+            }
+
+            if (acceptKeyword("LIMIT")) {
+                const Token& count = next();
+                if (count.type != TokenType::Number) {
+                    throw std::invalid_argument("LIMIT expects a number");
+                }
+                plan.limit = parseInt(count.text);
+                if (plan.limit < 0) {
+                    throw std::invalid_argument("LIMIT must not be negative");
+                }
+            }
+
+            acceptSymbol(";");
+            if (peek().type != TokenType::End) {
+                throw std::invalid_argument("Unexpected '" + peek().text + "'");
+            }
+            checkAggregates(plan);
+            plan.paramCount = static_cast<std::size_t>(paramCount);
+            return plan;
+        }
+
+    private:
+        std::vector<Token> tokens;
+        std::size_t pos = 0;
+        int paramCount = 0;        // Placeholders seen so far
+
+        const Token& peek() const { return tokens[pos]; }
+        const Token& next() {
+            const Token& token = tokens[pos];
+            if (token.type != TokenType::End) {
+                pos++;
+            }
+            return token;
+        }
+
+        static bool isKeyword(const Token& token) {
+            static const char* keywords[] = { "SELECT", "FROM", "WHERE", "AND", "OR", "BETWEEN",
+                "ORDER", "BY", "ASC", "DESC", "LIMIT", "LIKE", "GROUP" };
+            for (const char* keyword : keywords) {
+                if (equalsIgnoreCase(token.text, keyword)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool acceptKeyword(const char* keyword) {
+            if (peek().type == TokenType::Identifier && equalsIgnoreCase(peek().text, keyword)) {
+                pos++;
+                return true;
+            }
+            return false;
+        }
+
+        void expectKeyword(const char* keyword) {
+            if (!acceptKeyword(keyword)) {
+                throw std::invalid_argument(std::string("Expected ") + keyword);
+            }
+        }
+
+        bool acceptSymbol(const char* symbol) {
+            if (peek().type == TokenType::Symbol && peek().text == symbol) {
+                pos++;
+                return true;
+            }
+            return false;
+        }
+
+        void expectSymbol(const char* symbol) {
+            if (!acceptSymbol(symbol)) {
+                throw std::invalid_argument(std::string("Expected '") + symbol + "'");
+            }
+        }
+
+        // fn ( field ) or COUNT ( * ) for fn in COUNT, SUM, AVG, MIN, MAX
+        bool parseAggregate(AggregateColumn& column) {
+            static const struct { const char* name; AggregateOp op; } functions[] = {
+                { "COUNT", AggregateOp::Count }, { "SUM", AggregateOp::Sum }, { "AVG", AggregateOp::Avg },
+                { "MIN", AggregateOp::Min }, { "MAX", AggregateOp::Max } };
+            const Token& name = peek();
+            const Token& open = tokens[pos + (name.type == TokenType::End ? 0 : 1)];
+            if (name.type != TokenType::Identifier || open.type != TokenType::Symbol || open.text != "(") {
+                return false;
+            }
+            for (const auto& entry : functions) {
+                if (equalsIgnoreCase(name.text, entry.name)) {
+                    pos += 2;
+                    column.op = entry.op;
+                    if (entry.op == AggregateOp::Count && acceptSymbol("*")) {
+                        column.star = true;
+                    }
+                    else {
+                        column.field = parseField();
+                    }
+                    expectSymbol(")");
+                    if ((column.op == AggregateOp::Sum || column.op == AggregateOp::Avg) &&
+                        column.field != Field::Id && column.field != Field::Age && column.field != Field::Salary) {
+                        throw std::invalid_argument(std::string(entry.name) + " needs a numeric field, not " +
+                            fieldName(column.field));
+                    }
+                    return true;
+                }
+            }
+            throw std::invalid_argument("Unknown function '" + name.text + "'");
+        }
+
+        // An aggregate query may only select aggregates and the GROUP BY
+        // field, and may only be ordered by that field
+        static void checkAggregates(QueryPlan& plan) {
+            bool aggregate = plan.grouped;
+            for (const AggregateColumn& column : plan.aggregates) {
+                aggregate = aggregate || column.op != AggregateOp::Key;
+            }
+            if (!aggregate) {
+                plan.aggregates.clear();            // Plain field list
+                return;
+            }
+            if (plan.aggregates.empty()) {
+                throw std::invalid_argument("SELECT * cannot be combined with GROUP BY");
+            }
+            for (const AggregateColumn& column : plan.aggregates) {
+                if (column.op == AggregateOp::Key && (!plan.grouped || column.field != plan.groupBy)) {
+                    throw std::invalid_argument(std::string("Field ") + fieldName(column.field) +
+                        " must be aggregated or be the GROUP BY field");
+                }
+            }
+            for (const SortKey& key : plan.orderBy) {
+                if (!plan.grouped || key.field != plan.groupBy) {
+                    throw std::invalid_argument("An aggregate query can only be ordered by its GROUP BY field");
+                }
+            }
+            plan.projection.clear();
+        }
+
+        Field parseField() {
+            const Token& token = next();
+            if (token.type == TokenType::Identifier) {
+                static const struct { const char* name; Field field; } fields[] = {
+                    { "id", Field::Id }, { "firstName", Field::FirstName }, { "lastName", Field::LastName },
+                    { "ssn", Field::SSN }, { "salary", Field::Salary }, { "age", Field::Age } };
+                for (const auto& entry : fields) {
+                    if (equalsIgnoreCase(token.text, entry.name)) {
+                        return entry.field;
+                    }
+                }
+            }
+            throw std::invalid_argument("Unknown field '" + token.text + "'");
+        }
+
+        // Reads a literal and converts it to the type of field
+        // (a ? placeholder is numbered and converted when the plan is bound)
+        TypedValue parseLiteral(Field field) {
+            const Token& token = next();
+            TypedValue value;
+            if (token.type == TokenType::Symbol && token.text == "?") {
+                value.param = paramCount++;
+                return value;
+            }
+            if (token.type == TokenType::End || token.type == TokenType::Symbol) {
+                throw std::invalid_argument("Expected a value");
+            }
+            convertLiteral(field, token.text, value);
+            return value;
+        }
+
+        CompareOp parseOperator() {
+            const Token& token = next();
+            if (token.type == TokenType::Symbol) {
+                if (token.text == "=") return CompareOp::EQ;
+                if (token.text == "!=" || token.text == "<>") return CompareOp::NE;
+                if (token.text == "<") return CompareOp::LT;
+                if (token.text == "<=") return CompareOp::LE;
+                if (token.text == ">") return CompareOp::GT;
+                if (token.text == ">=") return CompareOp::GE;
+            }
+            throw std::invalid_argument("Expected a comparison operator");
+        }
+
+        static Predicate compare(Field field, CompareOp op, TypedValue value) {
+            Predicate leaf;
+            leaf.kind = Predicate::Kind::Compare;
+            leaf.field = field;
+            leaf.op = op;
+            leaf.value = std::move(value);
+            return leaf;
+        }
+
+        // expr := and { OR and }
+        Predicate parseOr() {
+            Predicate left = parseAnd();
+            if (!(peek().type == TokenType::Identifier && equalsIgnoreCase(peek().text, "OR"))) {
+                return left;
+            }
+            Predicate node;
+            node.kind = Predicate::Kind::Or;
+            node.children.push_back(std::move(left));
+            while (acceptKeyword("OR")) {
+                node.children.push_back(parseAnd());
+            }
+            return node;
+        }
+
+        // and := primary { AND primary }
+        Predicate parseAnd() {
+            Predicate left = parsePrimary();
+            if (!(peek().type == TokenType::Identifier && equalsIgnoreCase(peek().text, "AND"))) {
+                return left;
+            }
+            Predicate node;
+            node.kind = Predicate::Kind::And;
+            node.children.push_back(std::move(left));
+            while (acceptKeyword("AND")) {
+                node.children.push_back(parsePrimary());
+            }
+            return node;
+        }
+
+        // primary := ( expr ) | field op literal | field BETWEEN literal AND literal
+        //          | field LIKE literal
+        Predicate parsePrimary() {
+            if (acceptSymbol("(")) {
+                Predicate inner = parseOr();
+                expectSymbol(")");
+                return inner;
+            }
+
+            Field field = parseField();
+            if (acceptKeyword("BETWEEN")) {
+                TypedValue low = parseLiteral(field);
+                expectKeyword("AND");
+                TypedValue high = parseLiteral(field);
+                Predicate node;
+                node.kind = Predicate::Kind::And;
+                node.children.push_back(compare(field, CompareOp::GE, std::move(low)));
+                node.children.push_back(compare(field, CompareOp::LE, std::move(high)));
+                return node;
+            }
+            if (acceptKeyword("LIKE")) {
+                if (field != Field::FirstName && field != Field::LastName && field != Field::SSN) {
+                    throw std::invalid_argument(std::string("LIKE needs a text field, not ") + fieldName(field));
+                }
+                Predicate leaf = compare(field, CompareOp::PREFIX, parseLiteral(field));
+                if (leaf.value.param < 0) {
+                    applyLikePattern(leaf);
+                }
+                return leaf;
+            }
+
+            CompareOp op = parseOperator();
+            return compare(field, op, parseLiteral(field));
+        }
+    };
+
+    // Finds an "ssn = literal" conjunct that the SSN index can answer
+    bool findSSNEquality(const Predicate& predicate, std::uint32_t& key) {
+        if (predicate.kind == Predicate::Kind::Compare) {
+            if (predicate.field == Field::SSN && predicate.op == CompareOp::EQ && predicate.value.param < 0 &&
+                isValidSSN(predicate.value.text.c_str())) {
+                key = packSSN(predicate.value.text.c_str());
+                return true;
+            }
+            return false;
+        }
+        if (predicate.kind == Predicate::Kind::And) {
+            for (const Predicate& child : predicate.children) {
+                if (findSSNEquality(child, key)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Comparison leaves that must all hold for a row to match (nested ANDs included)
+    void collectConjuncts(const Predicate& predicate, std::vector<const Predicate*>& out) {
+        if (predicate.kind == Predicate::Kind::Compare) {
+            out.push_back(&predicate);
+        }
+        else if (predicate.kind == Predicate::Kind::And) {
+            for (const Predicate& child : predicate.children) {
+                collectConjuncts(child, out);
+            }
+        }
+    }
+
+    int compareValues(Field field, const TypedValue& a, const TypedValue& b) {
+        switch (field) {
+        case Field::Id:
+        case Field::Age: return threeWay(a.intValue, b.intValue);
+        case Field::Salary: return threeWay(a.floatValue, b.floatValue);
+        default: return threeWay(a.text, b.text);
+        }
+    }
+
+    // Finds the best range one of the ordered indexes (salary, age, lastName,
+    // SSN) can serve: an equality first, then a prefix, then a two-sided and
+    // finally a one-sided range
+    bool findIndexRange(const Predicate& filter, IndexRange& best) {
+        std::vector<const Predicate*> leaves;
+        collectConjuncts(filter, leaves);
+
+        static const Field indexed[] = { Field::SSN, Field::LastName, Field::Salary, Field::Age };
+        int bestScore = 0;
+        for (Field field : indexed) {
+            IndexRange range;
+            range.field = field;
+            bool equality = false;
+            const TypedValue* prefix = nullptr;
+            auto tightenLow = [&](const TypedValue& value, bool inclusive) {
+                int cmp = range.hasLow ? compareValues(field, value, range.low) : 1;
+                if (cmp > 0 || (cmp == 0 && !inclusive)) {
+                    range.hasLow = true;
+                    range.low = value;
+                    range.lowInclusive = inclusive;
+                }
+            };
+            auto tightenHigh = [&](const TypedValue& value, bool inclusive) {
+                int cmp = range.hasHigh ? compareValues(field, value, range.high) : -1;
+                if (cmp < 0 || (cmp == 0 && !inclusive)) {
+                    range.hasHigh = true;
+                    range.high = value;
+                    range.highInclusive = inclusive;
+                }
+            };
+
+            for (const Predicate* leaf : leaves) {
+                const TypedValue& value = leaf->value;
+                if (leaf->field != field || value.param >= 0) {
+                    continue;
+                }
+                if (field == Field::SSN && leaf->op != CompareOp::PREFIX && !isValidSSN(value.text.c_str())) {
+                    continue;               // The SSN index only holds well-formed SSNs
+                }
+                switch (leaf->op) {
+                case CompareOp::EQ: tightenLow(value, true); tightenHigh(value, true); equality = true; break;
+                case CompareOp::GT: tightenLow(value, false); break;
+                case CompareOp::GE: tightenLow(value, true); break;
+                case CompareOp::LT: tightenHigh(value, false); break;
+                case CompareOp::LE: tightenHigh(value, true); break;
+                case CompareOp::PREFIX:
+                    if (field == Field::LastName && !prefix) {
+                        prefix = &value;
+                    }
+                    break;
+                case CompareOp::NE: break;
+                }
+            }
+
+            int score = equality ? 4 : prefix ? 3 : (range.hasLow && range.hasHigh) ? 2 :
+                (range.hasLow || range.hasHigh) ? 1 : 0;
+            if (prefix && !equality) {
+                range.prefix = true;
+                range.hasLow = true;
+                range.lowInclusive = true;
+                range.low = *prefix;
+                range.hasHigh = false;
+            }
+            if (score > bestScore) {
+                best = range;
+                bestScore = score;
+            }
+        }
+        return bestScore > 0;
+    }
+
+    template <std::size_t N>
+    void filterText(const std::vector<std::array<char, N>>& column, CompareOp op,
+        const std::string& value, std::size_t begin, std::size_t end, SelectionBitmap& out) {
+        out.assign((end - begin + 63) / 64, 0);
+        for (std::size_t i = begin; i < end; i++) {
+            if (applyOp(op, compareText(op, column[i].data(), value))) {
+                out[(i - begin) / 64] |= std::uint64_t(1) << ((i - begin) % 64);
+            }
+        }
+    }
+}
+
+const char* fieldName(Field field) {
+    switch (field) {
+    case Field::Id: return "id";
+    case Field::FirstName: return "firstName";
+    case Field::LastName: return "lastName";
+    case Field::SSN: return "ssn";
+    case Field::Salary: return "salary";
+    case Field::Age: return "age";
+    }
+    return "";
+}
+
+// Column header of an aggregate result, e.g. "AVG(salary)" or the group key's field
+std::string aggregateName(const AggregateColumn& column) {
+    static const char* names[] = { "COUNT", "SUM", "AVG", "MIN", "MAX" };
+    if (column.op == AggregateOp::Key) {
+        return fieldName(column.field);
+    }
+    return std::string(names[static_cast<int>(column.op)]) + "(" + (column.star ? "*" : fieldName(column.field)) + ")";
+}
+
+// Splits the query into identifiers, numbers, quoted strings and symbols
+std::vector<Token> tokenizeQuery(const std::string& query) {
+    std::vector<Token> tokens;
+    std::size_t i = 0;
+    while (i < query.size()) {
+        unsigned char c = static_cast<unsigned char>(query[i]);
+        if (std::isspace(c)) {
+            i++;
+        }
+        else if (std::isalpha(c) || c == '_') {
+            std::size_t start = i;
+            while (i < query.size() && (std::isalnum(static_cast<unsigned char>(query[i])) || query[i] == '_')) {
+                i++;
+            }
+            tokens.push_back({ TokenType::Identifier, query.substr(start, i - start) });
+        }
+        else if (std::isdigit(c) || ((c == '-' || c == '.') && i + 1 < query.size() &&
+            std::isdigit(static_cast<unsigned char>(query[i + 1])))) {
+            // Numbers, including unquoted SSNs such as 123-45-6789
+            std::size_t start = i;
+            i++;
+            while (i < query.size() && (std::isdigit(static_cast<unsigned char>(query[i])) ||
+                query[i] == '.' || query[i] == '-')) {
+                i++;
+            }
+            tokens.push_back({ TokenType::Number, query.substr(start, i - start) });
+        }
+        else if (c == '\'' || c == '"') {
+            std::size_t end = query.find(static_cast<char>(c), i + 1);
+            if (end == std::string::npos) {
+                throw std::invalid_argument("Unterminated string literal");
+            }
+            tokens.push_back({ TokenType::String, query.substr(i + 1, end - i - 1) });
+            i = end + 1;
+        }
+        else {
+            // Two-character operators first, then single characters
+            std::string two = query.substr(i, 2);
+            if (two == "<=" || two == ">=" || two == "!=" || two == "<>") {
+                tokens.push_back({ TokenType::Symbol, two });
+                i += 2;
+            }
+            else if (std::strchr("*,()=<>;?", c)) {
+                tokens.push_back({ TokenType::Symbol, std::string(1, static_cast<char>(c)) });
+                i++;
+            }
+            else {
+                throw std::invalid_argument(std::string("Unexpected character '") + static_cast<char>(c) + "'");
+            }
+        }
+    }
+    tokens.push_back({ TokenType::End, "end of query" });
+    return tokens;
+}
+
+namespace {
+    // Picks the access path once every literal in the filter is known
+    void chooseAccessPath(QueryPlan& plan) {
+        plan.access = QueryPlan::Access::FullScan;
+        if (!plan.hasFilter) {
+            return;
+        }
+        // An equality on SSN turns the full scan into a single index probe
+        if (findSSNEquality(plan.filter, plan.ssnKey)) {
+            plan.access = QueryPlan::Access::SSNLookup;
+        }
+        else if (findIndexRange(plan.filter, plan.range)) {
+            plan.access = QueryPlan::Access::IndexRange;
+        }
+    }
+
+    // Fills every placeholder leaf with its converted parameter value
+    void bindPredicate(Predicate& predicate, const std::vector<std::string>& values) {
+        if (predicate.kind != Predicate::Kind::Compare) {
+            for (Predicate& child : predicate.children) {
+                bindPredicate(child, values);
+            }
+            return;
+        }
+        int param = predicate.value.param;
+        if (param >= 0) {
+            convertLiteral(predicate.field, values[static_cast<std::size_t>(param)], predicate.value);
+            predicate.value.param = -1;
+            if (predicate.op == CompareOp::PREFIX) {
+                applyLikePattern(predicate);
+            }
+        }
+    }
+
+    // True when a token sits where the grammar expects a literal value
+    bool isLiteralPosition(const std::vector<Token>& tokens, std::size_t i) {
+        if (tokens[i].type == TokenType::Number || tokens[i].type == TokenType::String) {
+            // LIMIT counts shape the plan and stay part of the statement text
+            return !(i > 0 && tokens[i - 1].type == TokenType::Identifier &&
+                equalsIgnoreCase(tokens[i - 1].text, "LIMIT"));
+        }
+        if (tokens[i].type != TokenType::Identifier || i == 0) {
+            return false;
+        }
+        // Bare words such as Smith in "lastName = Smith"
+        const Token& prev = tokens[i - 1];
+        if (prev.type == TokenType::Symbol && prev.text != "," && prev.text != "(" &&
+            prev.text != ")" && prev.text != "*" && prev.text != ";") {
+            return true;
+        }
+        if (prev.type == TokenType::Identifier &&
+            (equalsIgnoreCase(prev.text, "BETWEEN") || equalsIgnoreCase(prev.text, "LIKE"))) {
+            return true;
+        }
+        return prev.type == TokenType::Identifier && equalsIgnoreCase(prev.text, "AND") && i >= 3 &&
+            tokens[i - 3].type == TokenType::Identifier && equalsIgnoreCase(tokens[i - 3].text, "BETWEEN");
+    }
+}
+
+// Parses the query and picks an access path
+QueryPlan compileQuery(const std::string& query) {
+    Parser parser(tokenizeQuery(query));
+    QueryPlan plan = parser.parse();
+    chooseAccessPath(plan);
+    return plan;
+}
+
+// Rewrites the query with every literal replaced by ? so queries that only
+// differ in their values share one normalized text (and one cached plan)
+std::string normalizeQuery(const std::string& query, std::vector<std::string>& literals) {
+    std::vector<Token> tokens = tokenizeQuery(query);
+    std::string normalized;
+    normalized.reserve(query.size());
+    literals.clear();
+    for (std::size_t i = 0; i + 1 < tokens.size(); i++) {        // Skip the End token
+        if (i > 0) {
+            normalized += ' ';
+        }
+        if (isLiteralPosition(tokens, i)) {
+            literals.push_back(tokens[i].text);
+            normalized += '?';
+        }
+        else {
+            normalized += tokens[i].text;
+        }
+    }
+    return normalized;
+}
+
+// Produces an executable copy of a prepared plan with its placeholders filled in
+QueryPlan bindQuery(const QueryPlan& prepared, const std::vector<std::string>& values) {
+    if (values.size() != prepared.paramCount) {
+        throw std::invalid_argument("Expected " + std::to_string(prepared.paramCount) +
+            " parameter(s), got " + std::to_string(values.size()));
+    }
+    QueryPlan plan = prepared;
+    if (plan.hasFilter && plan.paramCount > 0) {
+        bindPredicate(plan.filter, values);
+    }
+    plan.paramCount = 0;
+    chooseAccessPath(plan);
+    return plan;
+}
+
+// ---- StatementCache ----
+
+StatementCache::StatementCache(std::size_t capacity) : capacity(capacity) {}
+
+// Returns the cached plan for normalized text, compiling it on a miss
+std::shared_ptr<const QueryPlan> StatementCache::get(const std::string& normalized) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto found = entries.find(normalized);
+    if (found != entries.end()) {
+        // Move the entry to the front of the recency list
+        recency.splice(recency.begin(), recency, found->second.position);
+        hits++;
+        return found->second.plan;
+    }
+
+    misses++;
+    auto plan = std::make_shared<const QueryPlan>(compileQuery(normalized));
+    if (capacity == 0) {
+        return plan;
+    }
+    if (entries.size() >= capacity) {
+        // Evict the least recently used statement
+        entries.erase(recency.back());
+        recency.pop_back();
+    }
+    recency.push_front(normalized);
+    entries[normalized] = Entry{ plan, recency.begin() };
+    return plan;
+}
+
+void StatementCache::setCapacity(std::size_t newCapacity) {
+    std::lock_guard<std::mutex> guard(lock);
+    capacity = newCapacity;
+    while (entries.size() > capacity) {
+        entries.erase(recency.back());
+        recency.pop_back();
+    }
+}
+
+void StatementCache::clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    entries.clear();
+    recency.clear();
+}
+
+bool matchesRow(const Predicate& predicate, const Employee& emp) {
+    switch (predicate.kind) {
+    case Predicate::Kind::And:
+        for (const Predicate& child : predicate.children) {
+            if (!matchesRow(child, emp)) {
+                return false;
+            }
+        }
+        return true;
+    case Predicate::Kind::Or:
+        for (const Predicate& child : predicate.children) {
+            if (matchesRow(child, emp)) {
+                return true;
+            }
+        }
+        return false;
+    case Predicate::Kind::Compare:
+        break;
+    }
+
+    switch (predicate.field) {
+    case Field::Id:
+        return applyOp(predicate.op, threeWay(emp.id, predicate.value.intValue));
+    case Field::Age:
+        return applyOp(predicate.op, threeWay(emp.age, predicate.value.intValue));
+    case Field::Salary:
+        // NaN salaries only satisfy !=, matching IEEE comparison rules
+        if (emp.salary != emp.salary) {
+            return predicate.op == CompareOp::NE;
+        }
+        return applyOp(predicate.op, threeWay(emp.salary, predicate.value.floatValue));
+    default:
+        return applyOp(predicate.op, compareText(predicate.op, textOf(emp, predicate.field), predicate.value.text));
+    }
+}
+
+void evaluatePredicate(const Predicate& predicate, const ColumnStore& columns, SelectionBitmap& out) {
+    evaluatePredicate(predicate, columns, 0, columns.size(), out);
+}
+
+void evaluatePredicate(const Predicate& predicate, const ColumnStore& columns,
+    std::size_t begin, std::size_t end, SelectionBitmap& out) {
+    if (predicate.kind != Predicate::Kind::Compare) {
+        // Combine child bitmaps word by word
+        evaluatePredicate(predicate.children[0], columns, begin, end, out);
+        SelectionBitmap other(out.get_allocator());    // Same memory as out
+        for (std::size_t c = 1; c < predicate.children.size(); c++) {
+            evaluatePredicate(predicate.children[c], columns, begin, end, other);
+            if (predicate.kind == Predicate::Kind::And) {
+                intersectBitmaps(out, other);
+            }
+            else {
+                unionBitmaps(out, other);
+            }
+        }
+        return;
+    }
+
+    const TypedValue& value = predicate.value;
+    switch (predicate.field) {
+    case Field::Id: columns.filterId(predicate.op, value.intValue, begin, end, out); break;
+    case Field::Age: columns.filterAge(predicate.op, value.intValue, begin, end, out); break;
+    case Field::Salary: columns.filterSalary(predicate.op, value.floatValue, begin, end, out); break;
+    case Field::FirstName: filterText(columns.firstName, predicate.op, value.text, begin, end, out); break;
+    case Field::LastName: filterText(columns.lastName, predicate.op, value.text, begin, end, out); break;
+    case Field::SSN: filterText(columns.ssn, predicate.op, value.text, begin, end, out); break;
+    }
+}
+
+bool orderBefore(const std::vector<SortKey>& keys, const Employee& a, const Employee& b) {
+    for (const SortKey& key : keys) {
+        int cmp = 0;
+        switch (key.field) {
+        case Field::Id: cmp = threeWay(a.id, b.id); break;
+        case Field::Age: cmp = threeWay(a.age, b.age); break;
+        case Field::Salary: cmp = threeWay(a.salary, b.salary); break;
+        default: cmp = std::strcmp(textOf(a, key.field), textOf(b, key.field)); break;
+        }
+        if (cmp != 0) {
+            return key.ascending ? cmp < 0 : cmp > 0;
+        }
+    }
+    return false;
+}
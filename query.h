@@ -0,0 +1,152 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include "column_store.h"
+#include "record.h"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Employee fields that queries can reference
+enum class Field { Id, FirstName, LastName, SSN, Salary, Age };
+
+// Name used for a field in queries and output headers
+const char* fieldName(Field field);
+
+// ---- Lexer ----
+
+enum class TokenType { Identifier, Number, String, Symbol, End };
+
+struct Token {
+    TokenType type;
+    std::string text;         // Identifier/symbol text, or literal without quotes
+};
+
+// Splits query text into tokens; throws std::invalid_argument on bad input
+std::vector<Token> tokenizeQuery(const std::string& query);
+
+// ---- Compiled plan ----
+
+// A literal converted to the type of the field it is compared against
+struct TypedValue {
+    int intValue = 0;          // Id, Age
+    float floatValue = 0.0f;   // Salary
+    std::string text;          // FirstName, LastName, SSN
+    int param = -1;            // Placeholder number until the plan is bound
+};
+
+// Node of the WHERE expression tree. BETWEEN is compiled to GE AND LE.
+struct Predicate {
+    enum class Kind { Compare, And, Or };
+    Kind kind = Kind::Compare;
+    Field field = Field::Id;                 // Compare only
+    CompareOp op = CompareOp::EQ;            // Compare only
+    TypedValue value;                        // Compare only
+    std::vector<Predicate> children;         // And / Or
+};
+
+struct SortKey {
+    Field field;
+    bool ascending;
+};
+
+// Bounds of an ordered index scan on one field; rows outside the filter
+// are still rejected afterwards, so the bounds only need to be conservative
+struct IndexRange {
+    Field field = Field::Salary;
+    bool hasLow = false;
+    bool lowInclusive = true;
+    TypedValue low;
+    bool hasHigh = false;
+    bool highInclusive = true;
+    TypedValue high;
+    bool prefix = false;                     // low.text is a prefix (LIKE 'x%'); no high bound
+};
+
+// Aggregate functions in the select list. Key is the GROUP BY field itself.
+enum class AggregateOp { Count, Sum, Avg, Min, Max, Key };
+
+// Output column of an aggregate query
+struct AggregateColumn {
+    AggregateOp op = AggregateOp::Count;
+    Field field = Field::Id;                 // Argument, or the GROUP BY field for Key
+    bool star = false;                       // COUNT(*)
+};
+
+// Header used for an aggregate column, e.g. "AVG(salary)"
+std::string aggregateName(const AggregateColumn& column);
+
+// Executable form of a SELECT statement
+struct QueryPlan {
+    // How candidate rows are produced
+    enum class Access { FullScan, SSNLookup, IndexRange };
+    Access access = Access::FullScan;
+    std::uint32_t ssnKey = 0;                // Packed SSN for SSNLookup
+    IndexRange range;                        // Bounds for IndexRange
+
+    bool hasFilter = false;
+    Predicate filter;
+    std::vector<SortKey> orderBy;
+    long long limit = -1;                    // -1 means no LIMIT
+    std::vector<Field> projection;           // Empty means SELECT *
+    std::vector<AggregateColumn> aggregates; // Non-empty for aggregate queries
+    bool grouped = false;                    // GROUP BY present
+    Field groupBy = Field::Id;
+    std::size_t paramCount = 0;              // Unbound ? placeholders in the filter
+};
+
+// Parses and compiles a query; throws std::invalid_argument with a
+// description of the problem when the query is malformed
+QueryPlan compileQuery(const std::string& query);
+
+// Replaces each literal in the WHERE clause with ? and returns the literals
+// in order, e.g. "... WHERE ssn = '1'" -> "... WHERE ssn = ?" + {"1"}
+std::string normalizeQuery(const std::string& query, std::vector<std::string>& literals);
+
+// Copies a plan compiled with ? placeholders and converts values into them
+QueryPlan bindQuery(const QueryPlan& prepared, const std::vector<std::string>& values);
+
+// LRU cache of compiled plans keyed by normalized query text; thread-safe
+class StatementCache {
+public:
+    explicit StatementCache(std::size_t capacity = 64);
+
+    std::shared_ptr<const QueryPlan> get(const std::string& normalized);
+    void setCapacity(std::size_t capacity);
+    void clear();
+
+    std::size_t size() const { std::lock_guard<std::mutex> guard(lock); return entries.size(); }
+    std::uint64_t hitCount() const { std::lock_guard<std::mutex> guard(lock); return hits; }
+    std::uint64_t missCount() const { std::lock_guard<std::mutex> guard(lock); return misses; }
+
+private:
+    struct Entry {
+        std::shared_ptr<const QueryPlan> plan;
+        std::list<std::string>::iterator position;     // Place in the recency list
+    };
+
+    mutable std::mutex lock;                           // Shared by concurrent queries
+    std::size_t capacity;
+    std::list<std::string> recency;                    // Most recently used first
+    std::unordered_map<std::string, Entry> entries;
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+};
+
+// Row-at-a-time evaluation of a predicate tree
+bool matchesRow(const Predicate& predicate, const Employee& emp);
+
+// Vectorized evaluation of a predicate tree over the columns
+void evaluatePredicate(const Predicate& predicate, const ColumnStore& columns, SelectionBitmap& out);
+// Same over slots [begin, end) only; bit k of out stands for slot begin + k
+void evaluatePredicate(const Predicate& predicate, const ColumnStore& columns,
+    std::size_t begin, std::size_t end, SelectionBitmap& out);
+
+// Orders two records by the plan's ORDER BY keys (strict weak ordering)
+bool orderBefore(const std::vector<SortKey>& keys, const Employee& a, const Employee& b);
+
+#endif
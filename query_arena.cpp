@@ -0,0 +1,58 @@
+#include "query_arena.h"
+#include <algorithm>
+#include <new>
+
+QueryArena::QueryArena(std::size_t bytes)
+    : block(bytes ? new char[bytes] : nullptr), blockSize(bytes) {}
+
+QueryArena::~QueryArena() {
+    releaseOverflow();
+}
+
+void* QueryArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    // Sizes are rounded so every offset stays aligned like the block itself
+    std::size_t size = (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (alignment <= ALIGNMENT && size <= blockSize) {
+        std::size_t offset = used.fetch_add(size, std::memory_order_relaxed);
+        if (offset <= blockSize - size) {
+            return block.get() + offset;
+        }
+    }
+    alignment = std::max(alignment, ALIGNMENT);
+    void* data = ::operator new(bytes, std::align_val_t(alignment));
+    std::lock_guard<std::mutex> guard(overflowLock);
+    overflow.push_back(Overflow{ data, alignment });
+    overflowBytes += size;
+    return data;
+}
+
+void QueryArena::reset() {
+    // Everything the last operation needed, in one block next time
+    std::size_t needed = std::min(used.load(std::memory_order_relaxed), blockSize) + overflowBytes;
+    releaseOverflow();
+    if (needed > blockSize && blockSize < MAX_BLOCK_BYTES) {
+        blockSize = std::min(MAX_BLOCK_BYTES, std::max(needed, blockSize * 2));
+        block.reset(new char[blockSize]);
+    }
+    used.store(0, std::memory_order_relaxed);
+}
+
+ArenaLease::ArenaLease(QueryArena& shared, std::mutex& lock) : shared(shared), guard(lock, std::try_to_lock) {
+    if (!guard.owns_lock()) {
+        own.emplace();
+    }
+}
+
+ArenaLease::~ArenaLease() {
+    if (!own) {
+        shared.reset();
+    }
+}
+
+void QueryArena::releaseOverflow() {
+    for (const Overflow& allocation : overflow) {
+        ::operator delete(allocation.data, std::align_val_t(allocation.alignment));
+    }
+    overflow.clear();
+    overflowBytes = 0;
+}
@@ -0,0 +1,81 @@
+#ifndef QUERY_ARENA_H
+#define QUERY_ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+// Monotonic memory for the temporaries of one query: selection bitmaps,
+// per-chunk match lists and hash aggregation tables. Allocation bumps an
+// offset into one block, so it never takes a lock and deallocation is a
+// no-op; reset() frees everything at once. Requests that do not fit the
+// block come from the heap and are freed by reset(), which also grows the
+// block to what the operation used (up to MAX_BLOCK_BYTES), so a repeated
+// query shape stops touching malloc.
+//
+// Safe to allocate from several threads at once (the chunks of a parallel
+// scan); reset() must only run once nothing allocated is still alive.
+class QueryArena : public std::pmr::memory_resource {
+public:
+    static constexpr std::size_t DEFAULT_BYTES = 256 << 10;    // First block
+    static constexpr std::size_t MAX_BLOCK_BYTES = 16 << 20;   // Largest block kept between queries
+
+    explicit QueryArena(std::size_t bytes = DEFAULT_BYTES);
+    ~QueryArena() override;
+
+    QueryArena(const QueryArena&) = delete;
+    QueryArena& operator=(const QueryArena&) = delete;
+
+    void reset();
+    std::size_t capacity() const { return blockSize; }
+
+private:
+    static constexpr std::size_t ALIGNMENT = alignof(std::max_align_t);
+
+    struct Overflow {
+        void* data;
+        std::size_t alignment;
+    };
+
+    std::unique_ptr<char[]> block;
+    std::size_t blockSize;
+    std::atomic<std::size_t> used{0};      // May run past blockSize; only the first blockSize bytes are handed out
+    std::mutex overflowLock;               // Guards the two members below
+    std::vector<Overflow> overflow;        // Heap allocations since the last reset
+    std::size_t overflowBytes = 0;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void*, std::size_t, std::size_t) override {}     // Freed by reset()
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    void releaseOverflow();
+};
+
+// Lends one operation the shared arena, or a private one when another
+// operation holds it (the same pattern as the shared sorter). The shared
+// arena is reset when the lease ends, so heap overflow never outlives the
+// operation. Declare the lease before anything allocated from it.
+class ArenaLease {
+public:
+    ArenaLease(QueryArena& shared, std::mutex& lock);
+    ~ArenaLease();
+
+    ArenaLease(const ArenaLease&) = delete;
+    ArenaLease& operator=(const ArenaLease&) = delete;
+
+    QueryArena& arena() { return own ? *own : shared; }
+
+private:
+    QueryArena& shared;
+    std::unique_lock<std::mutex> guard;
+    std::optional<QueryArena> own;
+};
+
+// Record slots: query temporaries allocated from an arena, and result
+// rows on the heap (the default resource)
+using SlotBuffer = std::pmr::vector<std::size_t>;
+
+#endif
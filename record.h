@@ -0,0 +1,27 @@
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <cstdint>
+
+// Fixed-size employee record stored directly in the binary data file
+struct Employee {
+    int id;                  // Unique, auto-generated employee ID
+    char firstName[21];      // 20 chars + null terminator
+    char lastName[21];       // 20 chars + null terminator
+    char ssn[12];            // XXX-XX-XXXX + null terminator
+    float salary;
+    int age;
+    bool isDeleted;          // Logical deletion flag
+};
+
+// Returns true when ssn has the XXX-XX-XXXX format
+bool isValidSSN(const char* ssn);
+
+// Packs a valid XXX-XX-XXXX SSN into its 9-digit integer value
+std::uint32_t packSSN(const char* ssn);
+
+// Writes a packed SSN big-endian, the SSN index's key format (byte-wise key
+// order matches numeric order)
+void encodeSSNKey(std::uint32_t packed, unsigned char key[4]);
+
+#endif
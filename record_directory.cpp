@@ -0,0 +1,160 @@
+#include "record_directory.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    const char META_MAGIC[8] = { 'E', 'M', 'P', 'M', 'E', 'T', 'A', '1' };
+}
+
+// Reads just the superblock; an unreadable file leaves an empty, non-matching one
+RecordDirectory::RecordDirectory(const std::string& path) : path(path) {
+    std::memset(&super, 0, sizeof(Superblock));
+    file.open(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file) {
+        file.clear();
+        file.open(path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Cannot open metadata file " + path);
+        }
+    }
+    if (!file.read(reinterpret_cast<char*>(&super), sizeof(Superblock)) ||
+        std::memcmp(super.magic, META_MAGIC, sizeof(META_MAGIC)) != 0) {
+        std::memset(&super, 0, sizeof(Superblock));
+        super.recordCount = ~std::uint64_t(0);       // Never matches a real file
+    }
+    file.clear();
+}
+
+bool RecordDirectory::matches(std::size_t recordCount) const {
+    return super.recordCount == recordCount;
+}
+
+void RecordDirectory::writeSuperblock() {
+    file.clear();
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&super), sizeof(Superblock));
+    file.flush();
+}
+
+// Pulls the directory entries into memory on first use
+void RecordDirectory::load() {
+    if (loaded) {
+        return;
+    }
+    std::vector<Entry> raw(static_cast<std::size_t>(super.entryCount));
+    file.clear();
+    file.seekg(sizeof(Superblock));
+    file.read(reinterpret_cast<char*>(raw.data()), static_cast<std::streamsize>(raw.size() * sizeof(Entry)));
+    file.clear();
+
+    // Later entries win, so an id that was re-inserted maps to its newest slot
+    slots.clear();
+    slots.reserve(raw.size());
+    for (const Entry& entry : raw) {
+        slots[entry.id] = entry.slot;
+    }
+    loaded = true;
+}
+
+// Appends a directory entry and bumps the counters
+void RecordDirectory::recordInsert(int id, std::size_t slot) {
+    Entry entry{ id, 0, slot };
+    file.clear();
+    file.seekp(static_cast<std::streamoff>(sizeof(Superblock) + super.entryCount * sizeof(Entry)));
+    file.write(reinterpret_cast<const char*>(&entry), sizeof(Entry));
+
+    if (loaded) {
+        slots[id] = slot;
+    }
+
+    super.entryCount++;
+    super.recordCount = std::max<std::uint64_t>(super.recordCount, slot + 1);
+    super.liveCount++;
+    if (id >= super.nextId) {
+        super.nextId = id + 1;
+    }
+    writeSuperblock();
+}
+
+// Same as recordInsert for n consecutive slots, with one directory write
+void RecordDirectory::recordInsertBatch(const Employee* emps, std::size_t n, std::size_t firstSlot) {
+    std::vector<Entry> raw(n);
+    for (std::size_t i = 0; i < n; i++) {
+        raw[i] = Entry{ emps[i].id, 0, firstSlot + i };
+        if (loaded) {
+            slots[emps[i].id] = firstSlot + i;
+        }
+        if (emps[i].id >= super.nextId) {
+            super.nextId = emps[i].id + 1;
+        }
+    }
+    file.clear();
+    file.seekp(static_cast<std::streamoff>(sizeof(Superblock) + super.entryCount * sizeof(Entry)));
+    file.write(reinterpret_cast<const char*>(raw.data()), static_cast<std::streamsize>(n * sizeof(Entry)));
+
+    super.entryCount += n;
+    super.recordCount = std::max<std::uint64_t>(super.recordCount, firstSlot + n);
+    super.liveCount += n;
+    writeSuperblock();
+}
+
+void RecordDirectory::recordDelete(int id) {
+    if (loaded) {
+        slots.erase(id);
+    }
+    if (super.liveCount > 0) {
+        super.liveCount--;
+    }
+    writeSuperblock();
+}
+
+// Hash lookup; the slot may still hold a tombstone if the entry predates a delete
+bool RecordDirectory::find(int id, std::size_t& slot) {
+    load();
+    auto it = slots.find(id);
+    if (it == slots.end()) {
+        return false;
+    }
+    slot = static_cast<std::size_t>(it->second);
+    return true;
+}
+
+// Rewrites the superblock and directory from the data file. The next ID
+// never goes down: after a compaction the highest IDs may belong to records
+// that are gone, and those must not be handed out again.
+void RecordDirectory::rebuild(const RecordStore& store) {
+    std::int32_t oldNextId = super.nextId;      // 0 when the superblock was unreadable
+    std::memcpy(super.magic, META_MAGIC, sizeof(META_MAGIC));
+    super.nextId = std::max<std::int32_t>(1, oldNextId);
+    super.reserved = 0;
+    super.recordCount = store.size();
+    super.liveCount = 0;
+
+    std::vector<Entry> raw;
+    slots.clear();
+    for (std::size_t slot = 0; slot < store.size(); slot++) {
+        const Employee& emp = store.at(slot);
+        if (emp.id >= super.nextId) {
+            super.nextId = emp.id + 1;
+        }
+        // Deleted ids are never handed out again, so only live records need entries
+        if (!emp.isDeleted) {
+            super.liveCount++;
+            raw.push_back(Entry{ emp.id, 0, slot });
+            slots[emp.id] = slot;
+        }
+    }
+    super.entryCount = raw.size();
+    loaded = true;
+
+    file.close();
+    file.open(path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Cannot rewrite metadata file " + path);
+    }
+    file.write(reinterpret_cast<const char*>(&super), sizeof(Superblock));
+    file.write(reinterpret_cast<const char*>(raw.data()), static_cast<std::streamsize>(raw.size() * sizeof(Entry)));
+    file.flush();
+}
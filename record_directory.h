@@ -0,0 +1,70 @@
+#ifndef RECORD_DIRECTORY_H
+#define RECORD_DIRECTORY_H
+
+#include "record_store.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+// Superblock plus id -> record slot directory kept in a small side file.
+// The superblock holds the counters EmployeeDB needs at startup (nextId,
+// record and live counts) so opening the database does not scan the data
+// file. Directory entries are appended as records are written; the first
+// id lookup loads them into a hash table, so every later lookup is O(1).
+class RecordDirectory {
+public:
+    explicit RecordDirectory(const std::string& path);
+
+    RecordDirectory(const RecordDirectory&) = delete;
+    RecordDirectory& operator=(const RecordDirectory&) = delete;
+
+    // True when the superblock describes a data file with recordCount records
+    bool matches(std::size_t recordCount) const;
+
+    int nextId() const { return super.nextId; }
+    std::uint64_t recordCount() const { return super.recordCount; }
+    std::uint64_t liveCount() const { return super.liveCount; }
+
+    void recordInsert(int id, std::size_t slot);     // A live record was appended at slot
+    void recordInsertBatch(const Employee* emps, std::size_t n, std::size_t firstSlot);
+    void recordDelete(int id);                       // The live record with id was tombstoned
+
+    // Finds the slot currently holding id
+    bool find(int id, std::size_t& slot);
+    // Loads the directory now, so that later finds only read it
+    void preload() { load(); }
+
+    // Recomputes everything with one pass over the data file
+    void rebuild(const RecordStore& store);
+
+private:
+    // Fixed-size header at the start of the file
+    struct Superblock {
+        char magic[8];
+        std::int32_t nextId;
+        std::uint32_t reserved;
+        std::uint64_t recordCount;       // Records in the data file (live + deleted)
+        std::uint64_t liveCount;         // Records not marked deleted
+        std::uint64_t entryCount;        // Directory entries following the superblock
+    };
+
+    // One id -> slot mapping
+    struct Entry {
+        std::int32_t id;
+        std::uint32_t reserved;
+        std::uint64_t slot;
+    };
+
+    std::string path;
+    std::fstream file;
+    Superblock super;
+    std::unordered_map<int, std::uint64_t> slots;   // Hash index over the live directory entries
+    bool loaded = false;             // slots mirrors the file
+
+    void writeSuperblock();
+    void load();
+};
+
+#endif
@@ -0,0 +1,362 @@
+#include "record_sort.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const std::size_t MERGE_MIN_SEGMENT = 1 << 14;      // Smallest merge task
+
+    // First 8 bytes of a NUL-terminated name, zero padded, big-endian
+    std::uint64_t prefixKey(const char* text) {
+        std::uint64_t key = 0;
+        int i = 0;
+        for (; i < 8 && text[i] != '\0'; i++) {
+            key = (key << 8) | static_cast<unsigned char>(text[i]);
+        }
+        return key << (8 * (8 - i));
+    }
+
+    const char* nameOf(const Employee& emp, Field field) {
+        return field == Field::FirstName ? emp.firstName : emp.lastName;
+    }
+
+    // True when record a (in slot slotA) sorts before record b, using the
+    // order sortLive produces: field value, then slot
+    bool precedes(const Employee& a, std::size_t slotA, const Employee& b, std::size_t slotB,
+        Field field, bool ascending) {
+        std::uint64_t keyA = sortKeyOf(field, a);
+        std::uint64_t keyB = sortKeyOf(field, b);
+        if (keyA != keyB) {
+            return ascending ? keyA < keyB : keyA > keyB;
+        }
+        if (!isExactSortKey(field)) {
+            int cmp = std::strcmp(nameOf(a, field), nameOf(b, field));
+            if (cmp != 0) {
+                return ascending ? cmp < 0 : cmp > 0;
+            }
+        }
+        return slotA < slotB;
+    }
+
+    // Elements of a among the first k outputs of a stable merge of a and b
+    // (a wins ties): the smallest i with b[k - i - 1] < a[i]
+    template <typename Entry>
+    std::size_t coRank(std::size_t k, const Entry* a, std::size_t aSize, const Entry* b, std::size_t bSize) {
+        std::size_t lo = k > bSize ? k - bSize : 0;
+        std::size_t hi = std::min(k, aSize);
+        while (lo < hi) {
+            std::size_t i = lo + (hi - lo) / 2;
+            std::size_t j = k - i;
+            if (j > 0 && a[i].key <= b[j - 1].key) {
+                lo = i + 1;
+            }
+            else {
+                hi = i;
+            }
+        }
+        return lo;
+    }
+}
+
+std::uint32_t orderedIntKey(int value) {
+    return static_cast<std::uint32_t>(value) ^ 0x80000000u;
+}
+
+std::uint32_t orderedFloatKey(float value) {
+    if (value == 0.0f) {
+        value = 0.0f;               // -0 and +0 compare equal, so give them one key
+    }
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    // Negative floats: flip everything; positive: flip the sign bit
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+std::uint64_t sortKeyOf(Field field, const Employee& emp) {
+    switch (field) {
+    case Field::Id: return orderedIntKey(emp.id);
+    case Field::Age: return orderedIntKey(emp.age);
+    case Field::Salary: return orderedFloatKey(emp.salary);
+    case Field::SSN: return packSSN(emp.ssn);       // Fixed-width digits order like the number
+    case Field::FirstName:
+    case Field::LastName: return prefixKey(nameOf(emp, field));
+    }
+    return 0;
+}
+
+bool isExactSortKey(Field field) {
+    return field != Field::FirstName && field != Field::LastName;
+}
+
+void RecordSorter::sortLive(const Employee* records, std::size_t count, Field field, bool ascending,
+    std::vector<std::size_t>& out, ThreadPool* pool) {
+    if (entries.size() < count) {
+        entries.resize(count);
+        scratch.resize(count);
+    }
+
+    std::size_t n;
+    Entry* sorted;
+    if (pool && pool->size() > 1) {
+        sorted = sortParallel(records, count, field, ascending, *pool, n);
+    }
+    else {
+        n = extractKeys(records, 0, count, field, ascending, entries.data());
+        radixSort(entries.data(), scratch.data(), n);
+        sorted = entries.data();
+    }
+    if (!isExactSortKey(field)) {
+        breakPrefixTies(sorted, records, n, field, ascending);
+    }
+
+    out.reserve(out.size() + n);
+    for (std::size_t i = 0; i < n; i++) {
+        out.push_back(sorted[i].slot);
+    }
+}
+
+void RecordSorter::sortRange(const Employee* records, std::size_t begin, std::size_t end, Field field,
+    bool ascending, std::vector<std::size_t>& out) {
+    if (entries.size() < end - begin) {
+        entries.resize(end - begin);
+        scratch.resize(end - begin);
+    }
+    std::size_t n = extractKeys(records, begin, end, field, ascending, entries.data());
+    radixSort(entries.data(), scratch.data(), n);
+    if (!isExactSortKey(field)) {
+        breakPrefixTies(entries.data(), records, n, field, ascending);
+    }
+    out.reserve(out.size() + n);
+    for (std::size_t i = 0; i < n; i++) {
+        out.push_back(entries[i].slot);
+    }
+}
+
+// Writes the keys of the live records in [begin, end) to `to`; returns how
+// many. Descending order is ascending order of ~key, which keeps ties in
+// slot order.
+std::size_t RecordSorter::extractKeys(const Employee* records, std::size_t begin, std::size_t end,
+    Field field, bool ascending, Entry* to) const {
+    std::size_t n = 0;
+    for (std::size_t slot = begin; slot < end; slot++) {
+        const Employee& emp = records[slot];
+        if (!emp.isDeleted) {
+            std::uint64_t key = sortKeyOf(field, emp);
+            to[n++] = Entry{ ascending ? key : ~key, slot };
+        }
+    }
+    return n;
+}
+
+// One radix-sorted run per chunk, then rounds of pairwise merges that
+// ping-pong between the two scratch arrays. Runs are merged left with right,
+// so ties still come out in slot order. Returns the sorted entries.
+RecordSorter::Entry* RecordSorter::sortParallel(const Employee* records, std::size_t count,
+    Field field, bool ascending, ThreadPool& pool, std::size_t& n) {
+    std::size_t chunks = pool.size();
+    std::size_t chunkSize = (count + chunks - 1) / chunks;
+
+    struct Run {
+        std::size_t offset;
+        std::size_t size;
+    };
+    std::vector<Run> runs(chunks);
+    pool.parallelFor(chunks, [&](std::size_t c) {
+        std::size_t begin = std::min(count, c * chunkSize);
+        std::size_t end = std::min(count, begin + chunkSize);
+        std::size_t live = extractKeys(records, begin, end, field, ascending, entries.data() + begin);
+        radixSort(entries.data() + begin, scratch.data() + begin, live);
+        runs[c] = Run{ begin, live };
+    });
+
+    Entry* from = entries.data();
+    Entry* to = scratch.data();
+    while (runs.size() > 1) {
+        std::vector<Run> merged;
+        std::size_t offset = 0;
+        for (std::size_t r = 0; r < runs.size(); r += 2) {
+            const Run& a = runs[r];
+            if (r + 1 == runs.size()) {
+                std::copy(from + a.offset, from + a.offset + a.size, to + offset);
+                merged.push_back(Run{ offset, a.size });
+                offset += a.size;
+                continue;
+            }
+            const Run& b = runs[r + 1];
+            mergeRuns(from + a.offset, a.size, from + b.offset, b.size, to + offset, pool);
+            merged.push_back(Run{ offset, a.size + b.size });
+            offset += a.size + b.size;
+        }
+        runs.swap(merged);
+        std::swap(from, to);
+    }
+    n = runs[0].size;
+    return from + runs[0].offset;
+}
+
+// Merge path: the output is cut into equal segments and each task finds
+// where its segment starts in both inputs with a binary search
+void RecordSorter::mergeRuns(const Entry* a, std::size_t aSize, const Entry* b, std::size_t bSize,
+    Entry* to, ThreadPool& pool) {
+    std::size_t total = aSize + bSize;
+    std::size_t segments = std::max<std::size_t>(1, std::min(pool.size(), total / MERGE_MIN_SEGMENT));
+    std::size_t segmentSize = (total + segments - 1) / segments;
+    auto less = [](const Entry& x, const Entry& y) { return x.key < y.key; };
+
+    pool.parallelFor(segments, [&](std::size_t s) {
+        std::size_t begin = std::min(total, s * segmentSize);
+        std::size_t end = std::min(total, begin + segmentSize);
+        std::size_t ai = coRank(begin, a, aSize, b, bSize);
+        std::size_t aj = coRank(end, a, aSize, b, bSize);
+        std::merge(a + ai, a + aj, b + (begin - ai), b + (end - aj), to + begin, less);
+    });
+}
+
+// Stable LSD radix sort of data[0..n) by key, one byte per pass.
+// Passes whose byte is the same for every key are skipped, so 32-bit keys
+// cost at most four passes and narrow value ranges even fewer.
+void RecordSorter::radixSort(Entry* data, Entry* temp, std::size_t n) {
+    if (n < 2) {
+        return;
+    }
+
+    // All eight histograms in one read of the keys
+    std::size_t counts[8][256] = {};
+    for (std::size_t i = 0; i < n; i++) {
+        std::uint64_t key = data[i].key;
+        for (int pass = 0; pass < 8; pass++) {
+            counts[pass][(key >> (8 * pass)) & 0xFF]++;
+        }
+    }
+
+    Entry* from = data;
+    Entry* to = temp;
+    for (int pass = 0; pass < 8; pass++) {
+        std::size_t* count = counts[pass];
+        if (count[(from[0].key >> (8 * pass)) & 0xFF] == n) {
+            continue;               // Every key has the same byte here
+        }
+
+        // Counts -> starting offsets
+        std::size_t offset = 0;
+        for (int digit = 0; digit < 256; digit++) {
+            std::size_t c = count[digit];
+            count[digit] = offset;
+            offset += c;
+        }
+        for (std::size_t i = 0; i < n; i++) {
+            to[count[(from[i].key >> (8 * pass)) & 0xFF]++] = from[i];
+        }
+        std::swap(from, to);
+    }
+
+    if (from != data) {
+        std::copy(from, from + n, data);
+    }
+}
+
+// Names sharing an 8-byte prefix are ordered by the rest of the name with
+// an in-place sort of each tie run
+void RecordSorter::breakPrefixTies(Entry* sorted, const Employee* records, std::size_t n, Field field, bool ascending) {
+    std::size_t start = 0;
+    while (start < n) {
+        std::size_t end = start + 1;
+        while (end < n && sorted[end].key == sorted[start].key) {
+            end++;
+        }
+        // A prefix that ends in NUL holds the whole name, so such a run is all
+        // one name and already in slot order
+        std::uint64_t key = ascending ? sorted[start].key : ~sorted[start].key;
+        if (end - start > 1 && (key & 0xFF) != 0) {
+            std::sort(sorted + start, sorted + end, [&](const Entry& a, const Entry& b) {
+                int cmp = std::strcmp(nameOf(records[a.slot], field), nameOf(records[b.slot], field));
+                if (cmp != 0) {
+                    return ascending ? cmp < 0 : cmp > 0;
+                }
+                return a.slot < b.slot;
+            });
+        }
+        start = end;
+    }
+}
+
+bool SortOrderCache::sortLive(const Employee* records, std::size_t count, Field field, bool ascending,
+    SlotBuffer& out, RecordSorter& sorter, ThreadPool* pool) {
+    std::shared_ptr<Order> order;
+    {
+        std::lock_guard<std::mutex> guard(ordersLock);
+        std::shared_ptr<Order>& entry = orders[{ field, ascending }];
+        if (!entry) {
+            entry = std::make_shared<Order>();
+        }
+        entry->lastUse = ++useClock;
+        order = entry;
+        if (orders.size() > MAX_ORDERS) {
+            auto oldest = std::min_element(orders.begin(), orders.end(), [](const auto& a, const auto& b) {
+                return a.second->lastUse < b.second->lastUse;
+            });
+            orders.erase(oldest);
+        }
+    }
+    std::lock_guard<std::mutex> guard(order->lock);
+
+    std::size_t delta = count - std::min(count, order->covered);
+    if (order->covered > count || order->slots.empty() || delta > order->slots.size() / MAX_DELTA_FRACTION) {
+        order->slots.clear();
+        sorter.sortLive(records, count, field, ascending, order->slots, pool);
+        order->covered = count;
+        out.insert(out.end(), order->slots.begin(), order->slots.end());
+        return false;
+    }
+
+    if (delta == 0) {
+        std::size_t before = out.size();
+        for (std::size_t slot : order->slots) {
+            if (!records[slot].isDeleted) {
+                out.push_back(slot);
+            }
+        }
+        std::size_t live = out.size() - before;
+        if (order->slots.size() - live > order->slots.size() / MAX_DEAD_FRACTION) {
+            order->slots.assign(out.begin() + before, out.end());
+        }
+        return true;
+    }
+
+    std::vector<std::size_t> added;
+    sorter.sortRange(records, order->covered, count, field, ascending, added);
+
+    // Each new slot goes after everything that sorts before or ties with it
+    // (older slots win ties); the runs in between are copied without their
+    // tombstones
+    auto later = [&](std::size_t slot, std::size_t kept) {
+        return precedes(records[slot], slot, records[kept], kept, field, ascending);
+    };
+    auto copyLive = [&](const std::size_t* from, const std::size_t* to, std::vector<std::size_t>& into) {
+        for (; from != to; ++from) {
+            if (!records[*from].isDeleted) {
+                into.push_back(*from);
+            }
+        }
+    };
+    std::vector<std::size_t> merged;
+    merged.reserve(order->slots.size() + added.size());
+    const std::size_t* kept = order->slots.data();
+    const std::size_t* keptEnd = kept + order->slots.size();
+    for (std::size_t slot : added) {
+        const std::size_t* pos = std::upper_bound(kept, keptEnd, slot, later);
+        copyLive(kept, pos, merged);
+        merged.push_back(slot);
+        kept = pos;
+    }
+    copyLive(kept, keptEnd, merged);
+
+    order->slots.swap(merged);
+    order->covered = count;
+    out.insert(out.end(), order->slots.begin(), order->slots.end());
+    return true;
+}
+
+void SortOrderCache::clear() {
+    std::lock_guard<std::mutex> guard(ordersLock);
+    orders.clear();
+}
@@ -0,0 +1,99 @@
+#ifndef RECORD_SORT_H
+#define RECORD_SORT_H
+
+#include "query.h"
+#include "query_arena.h"
+#include "record.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Order-preserving unsigned encodings of the native key types
+std::uint32_t orderedIntKey(int value);
+std::uint32_t orderedFloatKey(float value);
+
+// Maps a field value to an unsigned integer whose order matches the field's
+// order: ints and floats are sign-flipped, SSNs are packed, and names use
+// their first 8 bytes big-endian (a prefix key; longer names can tie).
+std::uint64_t sortKeyOf(Field field, const Employee& emp);
+
+// True when sortKeyOf orders the field completely (everything but names)
+bool isExactSortKey(Field field);
+
+// Sorts record slots by one field with LSD radix sort over typed keys.
+// Key/slot pairs live in two scratch arrays owned by the sorter and reused
+// across calls, so a warm sorter sorts without touching the heap.
+// The sort is stable: equal keys keep their slot order in both directions.
+// Given a thread pool, each thread radix sorts one chunk of the file and the
+// sorted runs are combined with parallel (merge path) merges. Callers decide
+// when an input is big enough to be worth that and pass nullptr otherwise.
+class RecordSorter {
+public:
+    // Appends the slots of live records, ordered by field, to out
+    void sortLive(const Employee* records, std::size_t count, Field field, bool ascending,
+        std::vector<std::size_t>& out, ThreadPool* pool = nullptr);
+    // Same for the records in slots [begin, end) only, on the calling thread
+    void sortRange(const Employee* records, std::size_t begin, std::size_t end, Field field, bool ascending,
+        std::vector<std::size_t>& out);
+
+private:
+    struct Entry {
+        std::uint64_t key;
+        std::size_t slot;
+    };
+
+    std::vector<Entry> entries;        // Keys being sorted
+    std::vector<Entry> scratch;        // Radix pass destination
+
+    std::size_t extractKeys(const Employee* records, std::size_t begin, std::size_t end,
+        Field field, bool ascending, Entry* to) const;
+    Entry* sortParallel(const Employee* records, std::size_t count, Field field, bool ascending,
+        ThreadPool& pool, std::size_t& n);
+    static void radixSort(Entry* data, Entry* temp, std::size_t n);
+    static void mergeRuns(const Entry* a, std::size_t aSize, const Entry* b, std::size_t bSize,
+        Entry* to, ThreadPool& pool);
+    static void breakPrefixTies(Entry* sorted, const Employee* records, std::size_t n, Field field, bool ascending);
+};
+
+// Sorted orders kept between sorts, one per (field, direction). Records are
+// only ever appended or tombstoned in place, so a kept order stays correct
+// for the slots it has seen: a later sort radix sorts just the records
+// appended since and splices each into the order with a binary search.
+// Tombstoned slots are skipped on the way out and dropped from the order
+// when it is next rebuilt, or once they make up more than 1/MAX_DEAD_FRACTION
+// of it. Only the MAX_ORDERS most recently used orders are kept. Orders must
+// be cleared whenever slots change meaning (compaction), with no sort running.
+// Sorts of different orders run concurrently; sorts of the same order wait
+// for each other.
+class SortOrderCache {
+public:
+    // Appends the slots of live records in [0, count), ordered by field, to
+    // out; true when a kept order was brought up to date instead of
+    // sorting everything
+    bool sortLive(const Employee* records, std::size_t count, Field field, bool ascending,
+        SlotBuffer& out, RecordSorter& sorter, ThreadPool* pool = nullptr);
+    void clear();
+
+private:
+    struct Order {
+        std::mutex lock;
+        std::vector<std::size_t> slots;    // Sorted; may hold slots tombstoned since
+        std::size_t covered = 0;           // Records [0, covered) are in slots
+        std::uint64_t lastUse = 0;         // Guarded by ordersLock
+    };
+
+    static constexpr std::size_t MAX_DELTA_FRACTION = 4;   // Bigger deltas (> 1/4 of the order) resort everything
+    static constexpr std::size_t MAX_DEAD_FRACTION = 4;    // More tombstones (> 1/4 of the order) are dropped
+    static constexpr std::size_t MAX_ORDERS = 4;           // Orders kept; the least recently used goes first
+
+    std::mutex ordersLock;                 // Guards the map and the use clock, not the orders in it
+    std::map<std::pair<Field, bool>, std::shared_ptr<Order>> orders;    // Shared with sorts still using an evicted order
+    std::uint64_t useClock = 0;
+};
+
+#endif
@@ -0,0 +1,201 @@
+#include "record_store.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const std::size_t MIN_MAPPING = 1 << 20;      // Map at least 1 MiB up front
+
+    std::runtime_error ioError(const std::string& what, const std::string& path) {
+        return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+    }
+}
+
+RecordStore::RecordStore(const std::string& path)
+    : path(path), fd(-1), records(nullptr), mappedBytes(0), count(0) {
+    open();
+}
+
+RecordStore::~RecordStore() {
+    close();
+}
+
+// Opens (creating if needed) the data file and maps its contents
+void RecordStore::open() {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        throw ioError("Cannot open", path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        fd = -1;
+        throw ioError("Cannot stat", path);
+    }
+    // A trailing partial record (e.g. from a torn write) is ignored
+    count = static_cast<std::size_t>(st.st_size) / sizeof(Employee);
+    remap(count * sizeof(Employee));
+}
+
+void RecordStore::close() {
+    mapping.reset();
+    records = nullptr;
+    mappedBytes = 0;
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    count = 0;
+}
+
+// Maps at least minBytes of the file. The mapping may extend past the end
+// of the file; only the bytes that belong to whole records are ever read.
+void RecordStore::remap(std::size_t minBytes) {
+    std::size_t length = mappedBytes ? mappedBytes : MIN_MAPPING;
+    while (length < minBytes) {
+        length *= 2;                // Grow geometrically so appends stay amortized O(1)
+    }
+    if (records && length == mappedBytes) {
+        return;
+    }
+
+    void* address = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        throw ioError("Cannot map", path);
+    }
+    ::madvise(address, length, MADV_SEQUENTIAL);     // Scans dominate the access pattern
+
+    // The old mapping stays alive while anything still pins it
+    mapping.reset(address, [length](void* mapped) { ::munmap(mapped, length); });
+    records = static_cast<const Employee*>(address);
+    mappedBytes = length;
+}
+
+// Appends a record at the end of the file and grows the mapping if needed
+std::size_t RecordStore::append(const Employee& emp) {
+    return appendBatch(&emp, 1);
+}
+
+// Appends n records with a single write; returns the slot of the first one
+std::size_t RecordStore::appendBatch(const Employee* emps, std::size_t n) {
+    std::size_t first = count;
+    writeBytes(static_cast<off_t>(first * sizeof(Employee)), reinterpret_cast<const char*>(emps), n * sizeof(Employee));
+    count += n;
+    if (count * sizeof(Employee) > mappedBytes) {
+        remap(count * sizeof(Employee));
+    }
+    return first;
+}
+
+// Positioned write; the shared mapping sees the new bytes immediately
+void RecordStore::write(std::size_t slot, const Employee& emp) {
+    writeBytes(static_cast<off_t>(slot * sizeof(Employee)), reinterpret_cast<const char*>(&emp), sizeof(Employee));
+}
+
+void RecordStore::writeBytes(off_t offset, const char* bytes, std::size_t length) {
+    std::size_t done = 0;
+    while (done < length) {
+        ssize_t n = ::pwrite(fd, bytes + done, length - done, offset + static_cast<off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw ioError("Cannot write", path);
+        }
+        ioCounters.wrote(static_cast<std::size_t>(n));
+        done += static_cast<std::size_t>(n);
+    }
+}
+
+void RecordStore::sync() {
+    if (::fdatasync(fd) != 0) {
+        throw ioError("Cannot sync", path);
+    }
+    ioCounters.synced();
+}
+
+// The mapping keeps its length; the bytes past the new end are simply unused
+void RecordStore::truncate(std::size_t records) {
+    if (records >= count) {
+        return;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(records * sizeof(Employee))) != 0) {
+        throw ioError("Cannot truncate", path);
+    }
+    count = records;
+}
+
+// Copies live records into a temp file, makes it durable and renames it over
+// the data file. A crash at any point leaves either the old or the new file.
+std::size_t RecordStore::compact() {
+    std::string tempPath = path + ".compact";
+    int out = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        throw ioError("Cannot create", tempPath);
+    }
+
+    // Stream the survivors out in large batches
+    const std::size_t batchRecords = 4096;
+    std::vector<Employee> batch;
+    batch.reserve(batchRecords);
+    std::size_t kept = 0;
+    auto flushBatch = [&]() {
+        const char* bytes = reinterpret_cast<const char*>(batch.data());
+        std::size_t total = batch.size() * sizeof(Employee);
+        std::size_t done = 0;
+        while (done < total) {
+            ssize_t n = ::write(out, bytes + done, total - done);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                ::close(out);
+                ::unlink(tempPath.c_str());
+                throw ioError("Cannot write", tempPath);
+            }
+            ioCounters.wrote(static_cast<std::size_t>(n));
+            done += static_cast<std::size_t>(n);
+        }
+        batch.clear();
+    };
+    for (const Employee& emp : *this) {
+        if (!emp.isDeleted) {
+            batch.push_back(emp);
+            kept++;
+            if (batch.size() == batchRecords) {
+                flushBatch();
+            }
+        }
+    }
+    flushBatch();
+
+    if (::fsync(out) != 0) {
+        ::close(out);
+        ::unlink(tempPath.c_str());
+        throw ioError("Cannot sync", tempPath);
+    }
+    ioCounters.synced();
+    ::close(out);
+
+    std::size_t removed = count - kept;
+    close();
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        open();
+        throw ioError("Cannot replace", path);
+    }
+
+    // Make the rename itself durable
+    std::string::size_type slash = path.find_last_of('/');
+    std::string dir = (slash == std::string::npos) ? "." : path.substr(0, slash);
+    int dirFd = ::open(dir.c_str(), O_RDONLY);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+
+    open();
+    return removed;
+}
@@ -0,0 +1,62 @@
+#ifndef RECORD_STORE_H
+#define RECORD_STORE_H
+
+#include "metrics.h"
+#include "record.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+
+// Memory-mapped view of the fixed-size Employee record file.
+// The file is mapped once; reads are plain pointer accesses into the
+// mapping and appends grow it. Pointers returned by data()/at() stay
+// valid until the next append, which may move the mapping, unless the
+// mapping is pinned: a replaced mapping is only unmapped once its last
+// pin() handle is gone.
+class RecordStore {
+public:
+    explicit RecordStore(const std::string& path);
+    ~RecordStore();
+
+    RecordStore(const RecordStore&) = delete;
+    RecordStore& operator=(const RecordStore&) = delete;
+
+    std::size_t size() const { return count; }            // Records in the file
+    bool empty() const { return count == 0; }
+
+    // Zero-copy access to the records
+    const Employee* data() const { return records; }
+    const Employee& at(std::size_t slot) const { return records[slot]; }
+    const Employee* begin() const { return records; }
+    const Employee* end() const { return records + count; }
+    std::shared_ptr<const void> pin() const { return mapping; }
+
+    std::size_t append(const Employee& emp);               // Returns the new record's slot
+    std::size_t appendBatch(const Employee* emps, std::size_t n);   // Returns the first new slot
+    void write(std::size_t slot, const Employee& emp);     // Overwrites a record in place
+    void sync();                                           // Flushes written records to disk
+    void truncate(std::size_t records);                    // Drops every record from slot `records` on
+
+    // Rewrites the file without deleted records (temp file + rename) and
+    // remaps it; returns how many records were dropped
+    std::size_t compact();
+
+    const IOCounters& io() const { return ioCounters; }     // Writes and syncs; reads go through the mapping
+
+private:
+    std::string path;
+    int fd;                          // File descriptor backing the mapping
+    const Employee* records;         // Start of the mapping (nullptr when nothing is mapped)
+    std::size_t mappedBytes;         // Length of the current mapping
+    std::shared_ptr<const void> mapping;    // Owns the mapping; munmap runs when the last pin drops
+    std::size_t count;               // Number of whole records in the file
+    IOCounters ioCounters;
+
+    void open();
+    void close();
+    void remap(std::size_t minBytes);
+    void writeBytes(off_t offset, const char* bytes, std::size_t length);
+};
+
+#endif
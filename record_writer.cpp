@@ -0,0 +1,210 @@
+#include "record_writer.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    const std::size_t CHUNK_BYTES = 1 << 20;     // Buffer size handed to the stream at once
+
+    const Field ALL_FIELDS[] = { Field::Id, Field::FirstName, Field::LastName, Field::SSN, Field::Salary, Field::Age };
+}
+
+OutputFormat parseOutputFormat(const std::string& name) {
+    if (name == "text") return OutputFormat::Text;
+    if (name == "csv") return OutputFormat::CSV;
+    if (name == "jsonl" || name == "json") return OutputFormat::JSONLines;
+    if (name == "binary") return OutputFormat::Binary;
+    throw std::invalid_argument("Unknown output format '" + name + "' (expected text, csv, jsonl or binary)");
+}
+
+RecordWriter::RecordWriter(std::ostream& out, OutputFormat format, std::vector<Field> fields)
+    : out(out), outputFormat(format), fields(std::move(fields)) {
+    buffer.reserve(CHUNK_BYTES + 256);
+    if (this->fields.empty() && format != OutputFormat::Text) {
+        this->fields.assign(std::begin(ALL_FIELDS), std::end(ALL_FIELDS));
+    }
+    if (format == OutputFormat::CSV) {
+        for (std::size_t i = 0; i < this->fields.size(); i++) {
+            if (i > 0) {
+                buffer += ',';
+            }
+            buffer += fieldName(this->fields[i]);
+        }
+        buffer += '\n';
+    }
+}
+
+RecordWriter::~RecordWriter() {
+    try {
+        flush();
+    }
+    catch (const std::exception&) {
+        // Nothing can be reported from a destructor
+    }
+}
+
+void RecordWriter::write(const Employee& emp) {
+    switch (outputFormat) {
+    case OutputFormat::Text: appendText(emp); break;
+    case OutputFormat::CSV: appendCSV(emp); break;
+    case OutputFormat::JSONLines: appendJSON(emp); break;
+    case OutputFormat::Binary: buffer.append(reinterpret_cast<const char*>(&emp), sizeof(Employee)); break;
+    }
+    maybeFlush();
+}
+
+RecordWriter& RecordWriter::text(std::string_view value) {
+    buffer.append(value.data(), value.size());
+    maybeFlush();
+    return *this;
+}
+
+RecordWriter& RecordWriter::number(long long value) {
+    char digits[24];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, result.ptr);
+    return *this;
+}
+
+// Six significant digits in the shorter of fixed and scientific notation,
+// which is what std::cout prints for a float by default
+RecordWriter& RecordWriter::number(float value) {
+    char digits[32];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, 6);
+    buffer.append(digits, result.ptr);
+    return *this;
+}
+
+void RecordWriter::flush() {
+    if (!buffer.empty()) {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Error writing output");
+    }
+}
+
+void RecordWriter::maybeFlush() {
+    if (buffer.size() >= CHUNK_BYTES) {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+}
+
+void RecordWriter::appendShortest(float value) {
+    char digits[32];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, result.ptr);
+}
+
+// Quotes the field when it contains a comma or quote, doubling inner quotes
+void RecordWriter::appendCSVField(const char* value) {
+    if (std::strpbrk(value, ",\"\n") == nullptr) {
+        buffer += value;
+        return;
+    }
+    buffer += '"';
+    for (const char* p = value; *p; p++) {
+        if (*p == '"') {
+            buffer += '"';
+        }
+        buffer += *p;
+    }
+    buffer += '"';
+}
+
+void RecordWriter::appendJSONString(const char* value) {
+    static const char hex[] = "0123456789abcdef";
+    buffer += '"';
+    for (const char* p = value; *p; p++) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\') {
+            buffer += '\\';
+            buffer += static_cast<char>(c);
+        }
+        else if (c < 0x20) {
+            buffer += "\\u00";
+            buffer += hex[c >> 4];
+            buffer += hex[c & 0xF];
+        }
+        else {
+            buffer += static_cast<char>(c);
+        }
+    }
+    buffer += '"';
+}
+
+// The console's record block, or the selected fields separated by ", "
+void RecordWriter::appendText(const Employee& emp) {
+    if (fields.empty()) {
+        text("ID: ").number(static_cast<long long>(emp.id)).text("\n");
+        text("Name: ").text(emp.firstName).text(" ").text(emp.lastName).text("\n");
+        text("SSN: ").text(emp.ssn).text("\n");
+        text("Salary: $").number(emp.salary).text("\n");
+        text("Age: ").number(static_cast<long long>(emp.age)).text("\n");
+        buffer += separator;
+        return;
+    }
+    for (std::size_t i = 0; i < fields.size(); i++) {
+        if (i > 0) {
+            buffer += ", ";
+        }
+        switch (fields[i]) {
+        case Field::Id: number(static_cast<long long>(emp.id)); break;
+        case Field::FirstName: buffer += emp.firstName; break;
+        case Field::LastName: buffer += emp.lastName; break;
+        case Field::SSN: buffer += emp.ssn; break;
+        case Field::Salary: number(emp.salary); break;
+        case Field::Age: number(static_cast<long long>(emp.age)); break;
+        }
+    }
+    buffer += '\n';
+}
+
+void RecordWriter::appendCSV(const Employee& emp) {
+    for (std::size_t i = 0; i < fields.size(); i++) {
+        if (i > 0) {
+            buffer += ',';
+        }
+        switch (fields[i]) {
+        case Field::Id: number(static_cast<long long>(emp.id)); break;
+        case Field::FirstName: appendCSVField(emp.firstName); break;
+        case Field::LastName: appendCSVField(emp.lastName); break;
+        case Field::SSN: buffer += emp.ssn; break;
+        case Field::Salary: appendShortest(emp.salary); break;
+        case Field::Age: number(static_cast<long long>(emp.age)); break;
+        }
+    }
+    buffer += '\n';
+}
+
+void RecordWriter::appendJSON(const Employee& emp) {
+    buffer += '{';
+    for (std::size_t i = 0; i < fields.size(); i++) {
+        if (i > 0) {
+            buffer += ',';
+        }
+        buffer += '"';
+        buffer += fieldName(fields[i]);
+        buffer += "\":";
+        switch (fields[i]) {
+        case Field::Id: number(static_cast<long long>(emp.id)); break;
+        case Field::FirstName: appendJSONString(emp.firstName); break;
+        case Field::LastName: appendJSONString(emp.lastName); break;
+        case Field::SSN: appendJSONString(emp.ssn); break;
+        case Field::Salary:
+            if (std::isfinite(emp.salary)) {
+                appendShortest(emp.salary);
+            }
+            else {
+                buffer += "null";           // JSON has no NaN or infinity
+            }
+            break;
+        case Field::Age: number(static_cast<long long>(emp.age)); break;
+        }
+    }
+    buffer += "}\n";
+}
@@ -0,0 +1,67 @@
+#ifndef RECORD_WRITER_H
+#define RECORD_WRITER_H
+
+#include "query.h"
+#include "record.h"
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Formats employee rows can be written in
+enum class OutputFormat {
+    Text,           // The console's "ID: ..." record blocks (comma separated values when projected)
+    CSV,            // Header line, then one row per record
+    JSONLines,      // One JSON object per line
+    Binary          // Raw Employee records (the projection is ignored)
+};
+
+// Parses "text", "csv", "jsonl" or "binary"; throws std::invalid_argument otherwise
+OutputFormat parseOutputFormat(const std::string& name);
+
+// Buffered row writer. Rows are formatted with std::to_chars into one large
+// reusable buffer that goes to the stream in big chunks, rather than through
+// an iostream << per field. The CSV header is written on construction; call
+// flush() at the end to surface stream errors (the destructor flushes too,
+// but cannot report failure).
+class RecordWriter {
+public:
+    // fields selects and orders the columns; empty means all of them
+    RecordWriter(std::ostream& out, OutputFormat format, std::vector<Field> fields = {});
+    ~RecordWriter();
+
+    RecordWriter(const RecordWriter&) = delete;
+    RecordWriter& operator=(const RecordWriter&) = delete;
+
+    OutputFormat format() const { return outputFormat; }
+
+    // Text format only: line written after every full record block
+    void setSeparator(std::string_view line) { separator = line; }
+
+    void write(const Employee& emp);            // One row in the writer's format
+
+    // Free-form text, for messages and custom lines between rows
+    RecordWriter& text(std::string_view value);
+    RecordWriter& number(long long value);
+    RecordWriter& number(float value);           // Formatted like std::cout's default
+
+    void flush();                                // Throws std::runtime_error if the stream failed
+
+private:
+    std::ostream& out;
+    OutputFormat outputFormat;
+    std::vector<Field> fields;
+    std::string separator;
+    std::string buffer;
+
+    void maybeFlush();
+    void appendShortest(float value);           // Shortest text that reads back as the same float
+    void appendCSVField(const char* value);
+    void appendJSONString(const char* value);
+    void appendText(const Employee& emp);
+    void appendCSV(const Employee& emp);
+    void appendJSON(const Employee& emp);
+};
+
+#endif
@@ -0,0 +1,377 @@
+#include "employee.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Regression tests for the EmployeeDB engine, run by ctest.
+// Each test opens databases in a fresh temp directory (the database files
+// have fixed names) and reports every failed check; the exit status is 1 if
+// any check failed.
+
+namespace {
+    int failures = 0;
+
+    void check(bool ok, const char* test, const char* what) {
+        if (!ok) {
+            std::printf("FAIL %s: %s\n", test, what);
+            failures++;
+        }
+    }
+
+    // Employee number i; SSNs are unique per i
+    Employee makeEmployee(int i, std::uint32_t random = 0) {
+        Employee emp;
+        std::memset(&emp, 0, sizeof(Employee));
+        std::strcpy(emp.firstName, "Test");
+        const char* lastNames[] = { "Smith", "Smithson", "Lee", "Abcdefghijk", "Abcdefghij", "Garcia" };
+        std::snprintf(emp.lastName, sizeof(emp.lastName), "%s%u", lastNames[random % 6], (random >> 3) % 3);
+        unsigned n = static_cast<unsigned>(i);
+        std::snprintf(emp.ssn, sizeof(emp.ssn), "%03u-%02u-%04u", (100 + n / 1000000) % 1000, n / 10000 % 100, n % 10000);
+        emp.salary = static_cast<float>(1000 * ((random >> 5) % 50));
+        emp.age = static_cast<int>(18 + (random >> 11) % 50);
+        return emp;
+    }
+
+    // Runs test in an empty directory of its own
+    void inTempDir(const char* name, void (*test)()) {
+        char path[] = "/tmp/employeedb_test_XXXXXX";
+        if (!mkdtemp(path)) {
+            check(false, name, "cannot create a temp directory");
+            return;
+        }
+        std::filesystem::path previous = std::filesystem::current_path();
+        std::filesystem::current_path(path);
+        try {
+            test();
+        }
+        catch (const std::exception& e) {
+            check(false, name, e.what());
+        }
+        std::filesystem::current_path(previous);
+        std::filesystem::remove_all(path);
+    }
+
+    // A process that dies without closing the database loses nothing that
+    // was logged: the data file is redone from the log, even when its tail
+    // is torn and the superblock is gone
+    void crashRecovery() {
+        const char* name = "crash recovery";
+        pid_t pid = fork();
+        if (pid == 0) {
+            EmployeeDB db;
+            for (int i = 0; i < 600; i++) {
+                db.insert(makeEmployee(i));
+            }
+            for (int id = 1; id <= 600; id += 3) {
+                db.erase(id);
+            }
+            db.sync();
+            _exit(0);      // No checkpoint, no clean shutdown
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        check(WIFEXITED(status) && WEXITSTATUS(status) == 0, name, "writer process failed");
+
+        int fd = open("employees.dat", O_RDWR);
+        check(fd >= 0, name, "no data file");
+        if (fd >= 0) {
+            off_t end = lseek(fd, 0, SEEK_END);
+            char junk[64];
+            std::memset(junk, 0x5a, sizeof(junk));
+            check(pwrite(fd, junk, 20, end - static_cast<off_t>(sizeof(Employee)) + 10) == 20, name, "tear last record");
+            check(pwrite(fd, junk, sizeof(junk), end) == sizeof(junk), name, "append partial record");
+            close(fd);
+        }
+        std::remove("employees.meta");
+
+        EmployeeDB db;
+        check(db.recordCount() == 600, name, "record count after recovery");
+        check(db.liveCount() == 400, name, "live count after recovery");
+        std::optional<Employee> last = db.findById(600);
+        check(last && std::strcmp(last->ssn, makeEmployee(599).ssn) == 0, name, "torn last record redone");
+        check(!db.findById(1) && db.findById(2), name, "deletes redone");
+        check(db.findBySSN(makeEmployee(4).ssn).has_value(), name, "SSN index rebuilt");
+        bool duplicate = false;
+        try {
+            db.insert(makeEmployee(4));
+        }
+        catch (const std::exception&) {
+            duplicate = true;
+        }
+        check(duplicate, name, "duplicate SSN accepted after recovery");
+        check(db.insert(makeEmployee(1000)) == 601, name, "next ID after recovery");
+    }
+
+    // Compaction drops the highest IDs when their records are deleted; the
+    // next ID must still move past them, across restarts and crashes
+    void compactionKeepsIds() {
+        const char* name = "compaction IDs";
+        {
+            EmployeeDB db;
+            db.setCompactionThreshold(0);
+            for (int i = 0; i < 3; i++) {
+                db.insert(makeEmployee(i));
+            }
+            db.erase(3);
+            db.compact();
+            check(db.insert(makeEmployee(3)) == 4, name, "ID reused after compaction");
+            db.erase(4);
+            db.compact();
+        }
+        {
+            EmployeeDB db;
+            check(db.insert(makeEmployee(4)) == 5, name, "ID reused after restart");
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            EmployeeDB db;
+            db.setCompactionThreshold(0);
+            db.erase(5);
+            db.compact();
+            _exit(0);
+        }
+        waitpid(pid, nullptr, 0);
+        EmployeeDB db;
+        check(db.insert(makeEmployee(5)) == 6, name, "ID reused after crash");
+    }
+
+    // The SSN filter may only rule out SSNs that are absent: every stored
+    // SSN is found, through deletes, reinserts and filter rebuilds
+    void ssnFilterHasNoFalseNegatives() {
+        const char* name = "SSN filter";
+        EmployeeDB db;
+        std::vector<Mutation> batch;
+        for (int i = 0; i < 20000; i++) {
+            Mutation insert;
+            insert.emp = makeEmployee(i);
+            batch.push_back(insert);
+        }
+        db.applyBatch(batch);
+        for (int i = 20000; i < 20500; i++) {
+            db.insert(makeEmployee(i));
+        }
+        for (int id = 1; id <= 20500; id += 7) {
+            db.erase(id);
+        }
+        int missing = 0;
+        int phantom = 0;
+        for (int i = 0; i < 20500; i++) {
+            bool deleted = i % 7 == 0;
+            bool found = db.findBySSN(makeEmployee(i).ssn).has_value();
+            missing += !deleted && !found;
+            phantom += deleted && found;
+        }
+        check(missing == 0, name, "stored SSN not found");
+        check(phantom == 0, name, "deleted SSN found");
+        check(db.insert(makeEmployee(0)) > 0, name, "deleted SSN cannot be reused");
+        check(db.findBySSN(makeEmployee(0).ssn).has_value(), name, "reinserted SSN not found");
+        check(!db.findBySSN("999-99-9999"), name, "absent SSN found");
+    }
+
+    // Sorts that splice new records into a kept order must match a full
+    // stable sort, through inserts, deletes and compactions
+    void sortCacheSplice() {
+        const char* name = "sort cache";
+        std::mt19937 random(7);
+        EmployeeDB db;
+        db.setCompactionThreshold(0);
+        int next = 0;
+        std::vector<int> ids;
+        for (; next < 3000; next++) {
+            ids.push_back(db.insert(makeEmployee(next, random())));
+        }
+        for (int round = 0; round < 200; round++) {
+            int op = random() % 4;
+            int n = random() % 30;
+            if (op < 2) {
+                for (int i = 0; i < n; i++, next++) {
+                    ids.push_back(db.insert(makeEmployee(next, random())));
+                }
+            }
+            else if (op == 2) {
+                for (int i = 0; i < n && !ids.empty(); i++) {
+                    std::size_t at = random() % ids.size();
+                    db.erase(ids[at]);
+                    ids[at] = ids.back();
+                    ids.pop_back();
+                }
+            }
+            else if (round % 50 == 3) {
+                db.compact();
+            }
+            int field = 1 + random() % 4;
+            bool ascending = random() % 2;
+            QueryResult all = db.employees();
+            std::vector<Employee> expected(all.begin(), all.end());
+            std::stable_sort(expected.begin(), expected.end(), [&](const Employee& a, const Employee& b) {
+                int order;
+                switch (field) {
+                case 1: order = (a.salary > b.salary) - (a.salary < b.salary); break;
+                case 2: order = (a.age > b.age) - (a.age < b.age); break;
+                case 3: order = std::strcmp(a.lastName, b.lastName); break;
+                default: order = std::strcmp(a.ssn, b.ssn); break;
+                }
+                return ascending ? order < 0 : order > 0;
+            });
+            QueryResult sorted = db.sortedBy(field, ascending);
+            std::vector<int> want, got;
+            for (const Employee& emp : expected) {
+                want.push_back(emp.id);
+            }
+            for (const Employee& emp : sorted) {
+                got.push_back(emp.id);
+            }
+            if (want != got) {
+                check(false, name, "sorted order differs from a full sort");
+                return;
+            }
+        }
+        check(db.stats().events[static_cast<int>(Event::SortsReused)] > 0, name, "no kept order was reused");
+    }
+
+    // Queries reuse the shared arena, which grows past its first block and
+    // frees its overflow between queries; results must not change
+    void arenaReuse() {
+        const char* name = "arena reuse";
+        EmployeeDB db;
+        std::vector<Mutation> batch;
+        for (int i = 0; i < 60000; i++) {
+            Mutation insert;
+            insert.emp = makeEmployee(i, static_cast<std::uint32_t>(i) * 2654435761u);
+            batch.push_back(insert);
+        }
+        db.applyBatch(batch);
+        const std::vector<std::string> queries = {
+            "SELECT * FROM employees WHERE age > 20",
+            "SELECT * FROM employees WHERE salary >= 10000 AND age < 60",
+            "SELECT * FROM employees WHERE age > 30 ORDER BY salary DESC LIMIT 100",
+            "SELECT age, COUNT(*), AVG(salary) FROM employees GROUP BY age",
+        };
+        std::vector<std::vector<int>> first;
+        std::vector<std::size_t> groups;
+        for (int pass = 0; pass < 3; pass++) {
+            for (std::size_t q = 0; q < queries.size(); q++) {
+                QueryResult result = db.query(queries[q]);
+                std::vector<int> ids;
+                for (const Employee& emp : result) {
+                    ids.push_back(emp.id);
+                }
+                if (pass == 0) {
+                    first.push_back(ids);
+                    groups.push_back(result.aggregates().rows.size());
+                }
+                else {
+                    check(ids == first[q] && result.aggregates().rows.size() == groups[q], name, queries[q].c_str());
+                }
+            }
+        }
+        std::size_t expected = 0;
+        for (const Employee& emp : db.employees()) {
+            expected += emp.age > 20;
+        }
+        check(first[0].size() == expected, name, "scan result differs from the rows");
+
+        std::vector<QueryPlan> plans;
+        for (std::size_t q = 0; q < 3; q++) {
+            plans.push_back(db.planQuery(queries[q]));
+        }
+        for (int pass = 0; pass < 2; pass++) {
+            std::vector<QueryResult> results = db.queryBatch(plans);
+            for (std::size_t q = 0; q < plans.size(); q++) {
+                std::vector<int> ids;
+                for (const Employee& emp : results[q]) {
+                    ids.push_back(emp.id);
+                }
+                check(ids == first[q], name, "batched query differs");
+            }
+        }
+    }
+    // An import that fails partway keeps the batches it already appended;
+    // they must be indexed like any other rows
+    void failedImportIsIndexed() {
+        const char* name = "failed import";
+        const int rows = 20000;
+        const int broken = 15000;       // Past the first append batch
+        {
+            EmployeeDB db;
+            std::vector<Mutation> batch;
+            for (int i = 0; i < rows; i++) {
+                Mutation insert;
+                insert.emp = makeEmployee(i, static_cast<std::uint32_t>(i) * 2654435761u);
+                batch.push_back(insert);
+            }
+            db.applyBatch(batch);
+            check(db.exportCompact("rows.ecr") == rows, name, "export");
+        }
+        for (const char* file : { "employees.dat", "employees.meta", "employees.wal" }) {
+            std::remove(file);
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(".")) {
+            if (entry.path().extension() == ".idx") {
+                std::filesystem::remove(entry.path());
+            }
+        }
+
+        // A first-name code the dictionary does not have (24-byte header,
+        // 24-byte records, the code at offset 16)
+        int fd = open("rows.ecr", O_RDWR);
+        std::uint32_t badCode = 0xffffffffu;
+        check(fd >= 0 && pwrite(fd, &badCode, sizeof(badCode), 24 + broken * 24 + 16) == sizeof(badCode),
+            name, "corrupt the export");
+        if (fd >= 0) {
+            close(fd);
+        }
+
+        EmployeeDB db;
+        bool failed = false;
+        try {
+            db.importCompact("rows.ecr");
+        }
+        catch (const std::exception&) {
+            failed = true;
+        }
+        check(failed, name, "malformed record accepted");
+        std::size_t kept = db.liveCount();
+        check(kept > 0 && kept <= static_cast<std::size_t>(broken), name, "appended batches kept");
+        check(db.findBySSN(makeEmployee(0).ssn).has_value(), name, "imported SSN not found");
+
+        std::size_t expected = 0;
+        for (const Employee& emp : db.employees()) {
+            expected += emp.age == 20;
+        }
+        check(expected > 0 && db.query("SELECT * FROM employees WHERE age = 20").size() == expected,
+            name, "age index misses imported rows");
+        bool duplicate = false;
+        try {
+            db.insert(makeEmployee(0));
+        }
+        catch (const std::exception&) {
+            duplicate = true;
+        }
+        check(duplicate, name, "duplicate SSN accepted after a failed import");
+    }
+}
+
+int main() {
+    inTempDir("crash recovery", crashRecovery);
+    inTempDir("compaction IDs", compactionKeepsIds);
+    inTempDir("SSN filter", ssnFilterHasNoFalseNegatives);
+    inTempDir("sort cache", sortCacheSplice);
+    inTempDir("arena reuse", arenaReuse);
+    inTempDir("failed import", failedImportIsIndexed);
+    if (failures) {
+        std::printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("all tests passed\n");
+    return 0;
+}
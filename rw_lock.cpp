@@ -0,0 +1,42 @@
+#include "rw_lock.h"
+
+void ReadWriteLock::lock() {
+    std::unique_lock<std::mutex> guard(state);
+    writersWaiting++;
+    writerGate.wait(guard, [this]() { return !writer && readers == 0; });
+    writersWaiting--;
+    writer = true;
+}
+
+void ReadWriteLock::unlock() {
+    bool wakeWriter;
+    {
+        std::lock_guard<std::mutex> guard(state);
+        writer = false;
+        wakeWriter = writersWaiting > 0;
+    }
+    // Waiting writers go first; readers are let in once none are left
+    if (wakeWriter) {
+        writerGate.notify_one();
+    }
+    else {
+        readerGate.notify_all();
+    }
+}
+
+void ReadWriteLock::lock_shared() {
+    std::unique_lock<std::mutex> guard(state);
+    readerGate.wait(guard, [this]() { return !writer && writersWaiting == 0; });
+    readers++;
+}
+
+void ReadWriteLock::unlock_shared() {
+    bool wakeWriter;
+    {
+        std::lock_guard<std::mutex> guard(state);
+        wakeWriter = --readers == 0 && writersWaiting > 0;
+    }
+    if (wakeWriter) {
+        writerGate.notify_one();
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef RW_LOCK_H
+#define RW_LOCK_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+// Reader-writer lock that prefers writers: once a writer is waiting, new
+// readers queue behind it, so a steady stream of readers cannot starve
+// mutations (std::shared_mutex gives no such guarantee, and glibc's
+// favours readers). Works with std::shared_lock and std::unique_lock.
+class ReadWriteLock {
+public:
+    void lock();
+    void unlock();
+    void lock_shared();
+    void unlock_shared();
+
+private:
+    std::mutex state;
+    std::condition_variable readerGate;
+    std::condition_variable writerGate;
+    std::size_t readers = 0;          // Readers holding the lock
+    std::size_t writersWaiting = 0;
+    bool writer = false;              // A writer holds the lock
+};
+
+#endif
@@ -0,0 +1,113 @@
+#include "secondary_index.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    void putBigEndian(std::uint64_t value, std::size_t bytes, char* to) {
+        for (std::size_t i = 0; i < bytes; i++) {
+            to[i] = static_cast<char>(value >> (8 * (bytes - 1 - i)));
+        }
+    }
+
+    // Zero-padded name bytes; memcmp on them orders like strcmp
+    void putName(const char* text, std::size_t length, std::size_t width, char* to) {
+        std::memset(to, 0, width);
+        std::memcpy(to, text, std::min(length, width));
+    }
+}
+
+SecondaryIndex::SecondaryIndex(const std::string& path, Field field, BufferPool* pool)
+    : indexed(field), valueBytes(valueWidth(field)), tree(path, valueWidth(field) + sizeof(std::uint64_t), pool) {}
+
+std::size_t SecondaryIndex::valueWidth(Field field) {
+    switch (field) {
+    case Field::Salary:
+    case Field::Age: return sizeof(std::uint32_t);
+    case Field::LastName: return NAME_BYTES;
+    default: throw std::invalid_argument(std::string("No secondary index on ") + fieldName(field));
+    }
+}
+
+void SecondaryIndex::encodeRecord(const Employee& emp, std::size_t slot, char* key) const {
+    switch (indexed) {
+    case Field::Salary: putBigEndian(orderedFloatKey(emp.salary), valueBytes, key); break;
+    case Field::Age: putBigEndian(orderedIntKey(emp.age), valueBytes, key); break;
+    default: putName(emp.lastName, strnlen(emp.lastName, NAME_BYTES), NAME_BYTES, key); break;
+    }
+    putBigEndian(slot, sizeof(std::uint64_t), key + valueBytes);
+}
+
+void SecondaryIndex::encodeValue(const TypedValue& value, char* key) const {
+    switch (indexed) {
+    case Field::Salary: putBigEndian(orderedFloatKey(value.floatValue), valueBytes, key); break;
+    case Field::Age: putBigEndian(orderedIntKey(value.intValue), valueBytes, key); break;
+    default: putName(value.text.data(), value.text.size(), NAME_BYTES, key); break;
+    }
+}
+
+void SecondaryIndex::insert(const Employee& emp, std::size_t slot) {
+    std::vector<char> key(valueBytes + sizeof(std::uint64_t));
+    encodeRecord(emp, slot, key.data());
+    tree.insert(key.data(), slot);
+}
+
+void SecondaryIndex::erase(const Employee& emp, std::size_t slot) {
+    std::vector<char> key(valueBytes + sizeof(std::uint64_t));
+    encodeRecord(emp, slot, key.data());
+    tree.erase(key.data());
+}
+
+// The sorter already yields (value, slot) order, which is key order, so the
+// tree can be bulk loaded without a separate sort
+void SecondaryIndex::rebuild(const Employee* records, std::size_t count, RecordSorter& sorter, ThreadPool* pool) {
+    std::vector<std::size_t> slots;
+    sorter.sortLive(records, count, indexed, true, slots, pool);
+
+    std::size_t keyBytes = valueBytes + sizeof(std::uint64_t);
+    std::vector<char> keys(slots.size() * keyBytes);
+    std::vector<std::uint64_t> values(slots.size());
+    for (std::size_t i = 0; i < slots.size(); i++) {
+        encodeRecord(records[slots[i]], slots[i], &keys[i * keyBytes]);
+        values[i] = slots[i];
+    }
+    tree.bulkLoad(keys.data(), values.data(), slots.size());
+    tree.setStamp(count);
+}
+
+void SecondaryIndex::scan(const IndexRange& range, const std::function<bool(std::size_t slot)>& visit) {
+    std::size_t keyBytes = valueBytes + sizeof(std::uint64_t);
+    // Names longer than the field are truncated, which only loosens the
+    // bounds: both ends then have to include the truncated value
+    bool truncated = indexed == Field::LastName &&
+        ((range.hasLow && range.low.text.size() > NAME_BYTES) || (range.hasHigh && range.high.text.size() > NAME_BYTES));
+
+    std::vector<char> from(keyBytes);
+    if (range.hasLow) {
+        encodeValue(range.low, from.data());
+        // Slot bytes: all zeros starts at the value, all ones skips past it
+        bool inclusive = range.lowInclusive || truncated;
+        putBigEndian(inclusive ? 0 : UINT64_MAX, sizeof(std::uint64_t), from.data() + valueBytes);
+    }
+
+    std::vector<char> high(valueBytes);
+    if (range.hasHigh) {
+        encodeValue(range.high, high.data());
+    }
+    bool highInclusive = range.highInclusive || truncated;
+    std::size_t prefixBytes = range.prefix ? std::min(range.low.text.size(), NAME_BYTES) : 0;
+
+    tree.scan(range.hasLow ? from.data() : nullptr, [&](const char* key, std::uint64_t slot) {
+        if (range.prefix && std::memcmp(key, from.data(), prefixBytes) != 0) {
+            return false;           // Past the last name with this prefix
+        }
+        if (range.hasHigh) {
+            int cmp = std::memcmp(key, high.data(), valueBytes);
+            if (cmp > 0 || (cmp == 0 && !highInclusive)) {
+                return false;
+            }
+        }
+        return visit(static_cast<std::size_t>(slot));
+    });
+}
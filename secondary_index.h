@@ -0,0 +1,54 @@
+#ifndef SECONDARY_INDEX_H
+#define SECONDARY_INDEX_H
+
+#include "bplus_tree.h"
+#include "query.h"
+#include "record.h"
+#include "record_sort.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Persistent ordered index over one non-unique field (salary, age or
+// lastName), stored as a B+tree. Each key is the field's order-preserving
+// encoding followed by the record slot big-endian, which makes duplicate
+// values unique keys and keeps equal values in file order.
+class SecondaryIndex {
+public:
+    SecondaryIndex(const std::string& path, Field field, BufferPool* pool = nullptr);
+
+    Field field() const { return indexed; }
+
+    void insert(const Employee& emp, std::size_t slot);
+    void erase(const Employee& emp, std::size_t slot);
+
+    // Replaces the contents with the live records of the data file
+    void rebuild(const Employee* records, std::size_t count, RecordSorter& sorter, ThreadPool* pool);
+
+    // Visits the slots whose value falls inside range, in value order; the
+    // visitor returns false to stop. Bounds may be looser than the range
+    // (e.g. names longer than the field), so callers recheck the rows.
+    void scan(const IndexRange& range, const std::function<bool(std::size_t slot)>& visit);
+
+    // Number of data records the index has seen (see BPlusTree::stamp)
+    std::uint64_t stamp() const { return tree.stamp(); }
+    void setStamp(std::uint64_t value) { tree.setStamp(value); }
+    void flush() { tree.flush(); }
+
+    const IOCounters& io() const { return tree.io(); }
+
+private:
+    static constexpr std::size_t NAME_BYTES = 20;   // lastName without its terminator
+
+    Field indexed;
+    std::size_t valueBytes;         // Encoded field width; the slot follows
+    BPlusTree tree;
+
+    static std::size_t valueWidth(Field field);
+    void encodeRecord(const Employee& emp, std::size_t slot, char* key) const;
+    void encodeValue(const TypedValue& value, char* key) const;
+};
+
+#endif
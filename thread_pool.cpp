@@ -0,0 +1,117 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(std::size_t threads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads == 0) {
+        threads = 1;                // hardware_concurrency() may not know
+    }
+    for (std::size_t i = 0; i < threads; i++) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 0; i + 1 < threads; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t tasks, const std::function<void(std::size_t)>& body) {
+    if (tasks == 0) {
+        return;
+    }
+    if (workers.empty() || tasks == 1) {
+        for (std::size_t i = 0; i < tasks; i++) {
+            body(i);
+        }
+        return;
+    }
+
+    Batch batch;
+    batch.body = &body;
+    batch.remaining = tasks;
+
+    // Deal the tasks round-robin so every worker starts on its own deque
+    for (std::size_t i = 0; i < tasks; i++) {
+        Queue& queue = *queues[i % queues.size()];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.tasks.push_back(Task{ &batch, i });
+    }
+    pending += tasks;
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);     // Pairs with the predicate check in workerLoop
+    }
+    wake.notify_all();
+
+    // Help until every task of this batch is done
+    std::size_t self = queues.size() - 1;
+    while (batch.remaining.load(std::memory_order_acquire) > 0) {
+        if (!runOne(self)) {
+            std::this_thread::yield();
+        }
+    }
+    if (batch.error) {
+        std::rethrow_exception(batch.error);
+    }
+}
+
+// Runs one task from our own deque, or steals one; false if all were empty
+bool ThreadPool::runOne(std::size_t self) {
+    Task task{ nullptr, 0 };
+    {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+        }
+    }
+    for (std::size_t k = 1; !task.batch && k < queues.size(); k++) {
+        Queue& victim = *queues[(self + k) % queues.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+        }
+    }
+    if (!task.batch) {
+        return false;
+    }
+    pending--;
+
+    Batch& batch = *task.batch;
+    try {
+        (*batch.body)(task.index);
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> guard(batch.errorLock);
+        if (!batch.error) {
+            batch.error = std::current_exception();
+        }
+    }
+    batch.remaining.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void ThreadPool::workerLoop(std::size_t self) {
+    while (true) {
+        if (runOne(self)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepLock);
+        wake.wait(lock, [this]() { return stopping || pending.load() > 0; });
+        if (stopping) {
+            return;
+        }
+    }
+}
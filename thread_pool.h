@@ -0,0 +1,65 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads with one task deque each. A worker pops from
+// the back of its own deque and, when that is empty, steals from the front
+// of the others, so uneven chunks (e.g. selective filters) balance out.
+// The thread that calls parallelFor runs tasks as well instead of blocking,
+// which also makes nested parallelFor calls safe.
+class ThreadPool {
+public:
+    // threads counts the calling thread too; 0 means one per hardware thread
+    explicit ThreadPool(std::size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return workers.size() + 1; }
+
+    // Runs body(0) ... body(tasks - 1) across the pool and returns once all of
+    // them have finished. The first exception thrown by a task is rethrown.
+    void parallelFor(std::size_t tasks, const std::function<void(std::size_t)>& body);
+
+private:
+    // One parallelFor call
+    struct Batch {
+        const std::function<void(std::size_t)>* body;
+        std::atomic<std::size_t> remaining;
+        std::mutex errorLock;
+        std::exception_ptr error;
+    };
+
+    struct Task {
+        Batch* batch;
+        std::size_t index;
+    };
+
+    struct Queue {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;    // One per worker, the last for callers
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> pending{ 0 };          // Tasks queued but not yet taken
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    bool runOne(std::size_t self);
+    void workerLoop(std::size_t self);
+};
+
+#endif
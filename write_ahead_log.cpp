@@ -0,0 +1,203 @@
+#include "write_ahead_log.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char WAL_MAGIC[8] = { 'E', 'M', 'P', 'W', 'A', 'L', '0', '1' };
+
+    std::runtime_error ioError(const std::string& what, const std::string& path) {
+        return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+    }
+
+    // CRC-32 (IEEE 802.3, reflected), table driven
+    struct CRCTable {
+        std::uint32_t entries[256];
+        CRCTable() {
+            for (std::uint32_t i = 0; i < 256; i++) {
+                std::uint32_t c = i;
+                for (int bit = 0; bit < 8; bit++) {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                entries[i] = c;
+            }
+        }
+    };
+
+    std::uint32_t crc32(const unsigned char* bytes, std::size_t length) {
+        static const CRCTable table;
+        std::uint32_t crc = 0xFFFFFFFFu;
+        for (std::size_t i = 0; i < length; i++) {
+            crc = table.entries[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFu;
+    }
+}
+
+WriteAheadLog::WriteAheadLog(const std::string& path) : path(path), nextLsn(1), durableLsn(0) {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        throw ioError("Cannot open", path);
+    }
+    if (::pread(fd, &header, sizeof(Header), 0) != static_cast<ssize_t>(sizeof(Header)) ||
+        std::memcmp(header.magic, WAL_MAGIC, sizeof(WAL_MAGIC)) != 0) {
+        // New (or unreadable) log: nothing to replay, no checkpoint yet
+        std::memcpy(header.magic, WAL_MAGIC, sizeof(WAL_MAGIC));
+        header.checkpointRecords = NO_CHECKPOINT;
+        header.firstLsn = 1;
+        if (::ftruncate(fd, 0) != 0) {
+            throw ioError("Cannot truncate", path);
+        }
+        writeHeader();
+    }
+    nextLsn = header.firstLsn;
+    durableLsn = nextLsn - 1;
+    endOffset = sizeof(Header);
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    ::close(fd);
+}
+
+std::uint32_t WriteAheadLog::checksumOf(const Record& record) {
+    return crc32(reinterpret_cast<const unsigned char*>(&record) + sizeof(record.checksum),
+        sizeof(Record) - sizeof(record.checksum));
+}
+
+void WriteAheadLog::writeAt(std::uint64_t offset, const void* bytes, std::size_t length) {
+    const char* data = static_cast<const char*>(bytes);
+    std::size_t done = 0;
+    while (done < length) {
+        ssize_t n = ::pwrite(fd, data + done, length - done, static_cast<off_t>(offset + done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw ioError("Cannot write", path);
+        }
+        ioCounters.wrote(static_cast<std::size_t>(n));
+        done += static_cast<std::size_t>(n);
+    }
+}
+
+void WriteAheadLog::writeHeader() {
+    writeAt(0, &header, sizeof(Header));
+    if (::fdatasync(fd) != 0) {
+        throw ioError("Cannot sync", path);
+    }
+    ioCounters.synced();
+}
+
+// Entries are read until the first one that is short, fails its checksum or
+// breaks the sequence; that is where the last write before a crash stopped
+std::size_t WriteAheadLog::replay(const std::function<void(const Entry&)>& apply) {
+    std::lock_guard<std::mutex> guard(lock);
+    std::size_t applied = 0;
+    std::uint64_t offset = sizeof(Header);
+    std::uint64_t lsn = header.firstLsn;
+    std::vector<Record> chunk(4096);
+    bool intact = true;
+    while (intact) {
+        ssize_t n = ::pread(fd, chunk.data(), chunk.size() * sizeof(Record), static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw ioError("Cannot read", path);
+        }
+        ioCounters.read(static_cast<std::size_t>(n));
+        std::size_t whole = static_cast<std::size_t>(n) / sizeof(Record);
+        for (std::size_t i = 0; i < whole; i++) {
+            const Record& record = chunk[i];
+            if (record.lsn != lsn || checksumOf(record) != record.checksum ||
+                (record.op != static_cast<std::uint32_t>(Op::Insert) && record.op != static_cast<std::uint32_t>(Op::Delete))) {
+                intact = false;
+                break;
+            }
+            apply(Entry{ static_cast<Op>(record.op), record.slot, record.record });
+            applied++;
+            lsn++;
+            offset += sizeof(Record);
+        }
+        if (whole < chunk.size()) {
+            break;
+        }
+    }
+
+    // Drop the tail so new entries continue the sequence cleanly
+    if (::ftruncate(fd, static_cast<off_t>(offset)) != 0) {
+        throw ioError("Cannot truncate", path);
+    }
+    nextLsn = lsn;
+    durableLsn = lsn - 1;
+    endOffset = offset;
+    return applied;
+}
+
+std::uint64_t WriteAheadLog::append(Op op, std::size_t firstSlot, const Employee* records, std::size_t n) {
+    std::vector<Record> out(n);
+    std::memset(out.data(), 0, n * sizeof(Record));     // Padding is checksummed too
+    std::lock_guard<std::mutex> guard(lock);
+    for (std::size_t i = 0; i < n; i++) {
+        Record& record = out[i];
+        record.op = static_cast<std::uint32_t>(op);
+        record.lsn = nextLsn + i;
+        record.slot = firstSlot + i;
+        std::memcpy(&record.record, &records[i], sizeof(Employee));
+        record.checksum = checksumOf(record);
+    }
+    writeAt(endOffset, out.data(), n * sizeof(Record));
+    endOffset += n * sizeof(Record);
+    nextLsn += n;
+    return nextLsn - 1;
+}
+
+// Group commit: the first waiter syncs everything appended so far; callers
+// arriving meanwhile wait and are usually covered by that same sync
+void WriteAheadLog::commit(std::uint64_t lsn) {
+    std::unique_lock<std::mutex> guard(lock);
+    while (durableLsn < lsn) {
+        if (syncing) {
+            synced.wait(guard);
+            continue;
+        }
+        syncing = true;
+        std::uint64_t target = nextLsn - 1;
+        guard.unlock();
+        int result = ::fdatasync(fd);
+        ioCounters.synced();
+        guard.lock();
+        syncing = false;
+        if (result != 0) {
+            synced.notify_all();
+            throw ioError("Cannot sync", path);
+        }
+        durableLsn = std::max(durableLsn, target);
+        synced.notify_all();
+    }
+}
+
+// The header goes first: once it names the next lsn, the old entries no
+// longer replay even if the crash comes before the truncate
+void WriteAheadLog::checkpoint(std::uint64_t records) {
+    std::lock_guard<std::mutex> guard(lock);
+    header.checkpointRecords = records;
+    header.firstLsn = nextLsn;
+    writeHeader();
+    if (::ftruncate(fd, sizeof(Header)) != 0) {
+        throw ioError("Cannot truncate", path);
+    }
+    endOffset = sizeof(Header);
+    durableLsn = nextLsn - 1;
+}
+
+std::uint64_t WriteAheadLog::lastLsn() {
+    std::lock_guard<std::mutex> guard(lock);
+    return nextLsn - 1;
+}
+
+std::uint64_t WriteAheadLog::bytes() {
+    std::lock_guard<std::mutex> guard(lock);
+    return endOffset - sizeof(Header);
+}
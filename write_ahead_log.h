@@ -0,0 +1,102 @@
+#ifndef WRITE_AHEAD_LOG_H
+#define WRITE_AHEAD_LOG_H
+
+#include "metrics.h"
+#include "record.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+// Redo log for data file mutations. Every insert or delete appends a
+// checksummed entry holding the full after-image of the record before the
+// data file is touched, so replaying the log after a crash repairs torn or
+// missing record writes.
+//
+// Entries reach the OS as soon as they are appended; commit() makes them
+// durable. Commits use group commit: one caller (the leader) runs fdatasync
+// for every entry appended so far while the others wait for it, so
+// concurrent or batched mutations share a single sync.
+//
+// A checkpoint records how many records the (synced) data file holds and
+// empties the log.
+class WriteAheadLog {
+public:
+    enum class Op : std::uint32_t { Insert = 1, Delete = 2 };
+
+    // One logged mutation: write `record` at `slot`
+    struct Entry {
+        Op op;
+        std::uint64_t slot;
+        Employee record;
+    };
+
+    explicit WriteAheadLog(const std::string& path);
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // False until the first checkpoint of a newly created log
+    bool hasCheckpoint() const { return header.checkpointRecords != NO_CHECKPOINT; }
+    // Records in the data file as of the last checkpoint
+    std::uint64_t checkpointRecords() const { return header.checkpointRecords; }
+
+    // Calls apply for every intact entry since the last checkpoint, in log
+    // order, and cuts off a torn or corrupt tail. Returns the entry count.
+    std::size_t replay(const std::function<void(const Entry&)>& apply);
+
+    // Appends entries for records[0..n) at slots firstSlot, firstSlot + 1, ...
+    // with one write; returns the sequence number of the last one
+    std::uint64_t append(Op op, std::size_t firstSlot, const Employee* records, std::size_t n);
+
+    // Returns once every entry up to lsn is on stable storage
+    void commit(std::uint64_t lsn);
+    void sync() { commit(lastLsn()); }
+
+    // Empties the log. The caller must have synced a data file that holds
+    // every logged mutation and `records` records in total.
+    void checkpoint(std::uint64_t records);
+
+    std::uint64_t lastLsn();
+    std::uint64_t bytes();            // Entry bytes since the last checkpoint
+
+    const IOCounters& io() const { return ioCounters; }
+
+private:
+    static const std::uint64_t NO_CHECKPOINT = ~std::uint64_t(0);
+
+    struct Header {
+        char magic[8];
+        std::uint64_t checkpointRecords;
+        std::uint64_t firstLsn;       // Sequence number of the first entry after the header
+    };
+
+    // On-disk entry; the checksum covers everything after it
+    struct Record {
+        std::uint32_t checksum;
+        std::uint32_t op;
+        std::uint64_t lsn;
+        std::uint64_t slot;
+        Employee record;
+    };
+
+    std::string path;
+    int fd;
+    Header header;
+    std::mutex lock;                  // Guards everything below
+    std::condition_variable synced;
+    std::uint64_t nextLsn;
+    std::uint64_t durableLsn;         // Highest lsn known to be on disk
+    std::uint64_t endOffset;          // Where the next entry goes
+    bool syncing = false;             // A leader is inside fdatasync
+    IOCounters ioCounters;
+
+    void writeHeader();
+    void writeAt(std::uint64_t offset, const void* bytes, std::size_t length);
+    static std::uint32_t checksumOf(const Record& record);
+};
+
+#endif